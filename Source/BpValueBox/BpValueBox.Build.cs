@@ -1,8 +1,12 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
+using System;
 using System.Collections.Generic;
+using System.Linq;
 using System.Text;
 using System.IO;
+using System.Security.Cryptography;
+using System.Text.RegularExpressions;
 using EpicGames.Core;
 using UnrealBuildTool;
 
@@ -55,7 +59,89 @@ public class BpValueBox : ModuleRules
 				// ... add any modules that your module loads dynamically here ...
 			}
 		);
+		CheckValueTypesAreDeclared();
+		LoadManifest();
 		GenerateBoxedValueTypes();
+		GenerateVariantTypes();
+		GenerateVariantStatics();
+		GenerateVariantTypeTests();
+		GenerateVariantTupleTypes();
+		DeleteStaleFiles();
+		SaveManifest();
+	}
+
+	// Content hash of every generated file as of the last build, keyed by its path relative to the module
+	private readonly Dictionary<string, string> PreviousHashes = new();
+	private readonly Dictionary<string, string> GeneratedHashes = new();
+
+	private string ManifestPath => Path.Combine(PluginDirectory, "Intermediate", "BpValueBoxCodegen.manifest");
+
+	/*
+	One row per type a BpVariant can hold. Adding a row gives the type a variant arm, Blueprint functions,
+	serialization, hashing and a test, and a UBoxed class too if Boxed is set. The EValueType has to be added to
+	ValueType.h by hand, at the end of EValueType, after None, since saved variants store it. The build fails
+	until it is.
+	*/
+	private static readonly ValueTypeInfo[] ValueTypes =
+	{
+		new("bool", "Bool", "Bool", "true", true),
+		new("uint8", "Byte", "Byte", "200", true),
+		new("int32", "Int32", "Int", "-123456", true),
+		new("int64", "Int64", "Int64", "1234567890123", true),
+		new("float", "Float32", "Float", "1.5f", true),
+		new("double", "Float64", "Double", "-2.25", true),
+		new("FName", "Name", "Name", @"FName(TEXT(""Name""))", true),
+		new("FString", "String", "String", @"FString(TEXT(""String""))", true),
+		new("FText", "Text", "Text", @"FText::FromString(TEXT(""Text""))", true),
+		new("FVector", "Vector", "Vector", "FVector(1.0, 2.0, 3.0)", true),
+		new("FRotator", "Rotator", "Rotator", "FRotator(10.0, 20.0, 30.0)", true),
+		new("FTransform", "Transform", "Transform", "FTransform(FRotator(10.0, 20.0, 30.0), FVector(1.0, 2.0, 3.0))",
+			false),
+		new("FInstancedStruct", "Struct", "Struct", "FInstancedStruct::Make(FVector(1.0, 2.0, 3.0))", true),
+		new("UObject*", "Object", "Object", "GetTransientPackage()", false),
+		new("UClass*", "Class", "Class", "UObject::StaticClass()", false),
+		new("TSoftObjectPtr<UObject>", "SoftObject", "SoftObject", "TSoftObjectPtr<UObject>(GetTransientPackage())",
+			false),
+		new("TSoftClassPtr<UObject>", "SoftClass", "SoftClass", "TSoftClassPtr<UObject>(UObject::StaticClass())",
+			false),
+		// Are any of these necessary?
+		// new("FLinearColor", "LinearColor", "LinearColor", "FLinearColor(0.25f, 0.5f, 0.75f, 1.0f)", true),
+		// new("FColor", "Color", "Color", "FColor(64, 128, 192, 255)", true),
+		// new("FGuid", "Guid", "Guid", "FGuid(1, 2, 3, 4)", true),
+		// new("FQuat", "Quat", "Quat", "FQuat(FRotator(10.0, 20.0, 30.0))", true),
+		// new("FVector2D", "Vector2D", "Vector2D", "FVector2D(1.0, 2.0)", true),
+		// new("FDateTime", "DateTime", "DateTime", "FDateTime(2000, 1, 2)", true),
+		// new("FTimespan", "Timespan", "Timespan", "FTimespan::FromSeconds(90.0)", true),
+		// new("FSoftObjectPath", "SoftObjectPath", "SoftObjectPath", @"FSoftObjectPath(TEXT(""/Engine/Transient""))",
+		// 	true),
+		// new("FSoftClassPath", "SoftClassPath", "SoftClassPath", "FSoftClassPath(UObject::StaticClass())", true),
+	};
+
+	private class ValueTypeInfo
+	{
+		// The C++ type, as written in the variant arm
+		public readonly string Type;
+		// The EValueType it reports, which is also the suffix of its UBoxed class
+		public readonly string Name;
+		// The suffix of its BpVariant Blueprint functions
+		public readonly string FunctionName;
+		// A C++ expression for a value that isn't the default, for the generated tests
+		public readonly string Sample;
+		public readonly bool Boxed;
+
+		public ValueTypeInfo(string type, string name, string functionName, string sample, bool boxed)
+		{
+			Type = type;
+			Name = name;
+			FunctionName = functionName;
+			Sample = sample;
+			Boxed = boxed;
+		}
+
+		// Scalars and pointers are passed by value, everything else by const reference so it's never copied
+		public string Param => Type.EndsWith("*") ? Type : IsScalar ? $"const {Type}" : $"const {Type}&";
+
+		private bool IsScalar => Type is "bool" or "uint8" or "int32" or "int64" or "float" or "double";
 	}
 
 	private void GenerateBoxedValueTypes()
@@ -89,34 +175,113 @@ public class BpValueBox : ModuleRules
 		}
 		*/
 
-		List<(string type, string name)> types = new()
-		{
-			("FInstancedStruct", "Struct"),
-			("bool", "Bool"),
-			("uint8", "Byte"),
-			("int32", "Int32"),
-			("int64", "Int64"),
-			("float", "Float32"),
-			("double", "Float64"),
-			("FName", "Name"),
-			("FString", "String"),
-			("FText", "Text"),
-			("FVector", "Vector"),
-			("FRotator", "Rotator"),
-			// Are any of these necessary?
-			// ("FTransform", "Transform"),
-			// ("FLinearColor", "LinearColor"),
-			// ("FColor", "Color"),
-			// ("FGuid", "Guid"),
-			// ("FQuat", "Quat"),
-			// ("FVector2D", "Vector2D"),
-			// ("FDateTime", "DateTime"),
-			// ("FTimespan", "Timespan"),
-			// ("FSoftObjectPath", "SoftObjectPath"),
-			// ("FSoftClassPath", "SoftClassPath"),
-			// ("FSoftPackagePath", "SoftPackagePath"),
-			// ("FSoftAssetPath", "SoftAssetPath"),
-		};
+		// One header per type, so editing one box class only rebuilds the code that includes it. Adding a type still
+		// changes ValueType.h and the variant headers, which every user of BpVariant includes.
+		StringBuilder umbrella = new();
+		umbrella.AppendLine(@"
+// This file is automatically generated by BpValueBox.Build.cs. It will be overwritten during builds.
+// If you need to customize generation, modify BpValueBox.Build.cs instead.
+
+// Every box type. Code that only needs a few of them should include their own Boxed*_Generated.h instead.
+
+#pragma once
+");
+
+		foreach (ValueTypeInfo type in ValueTypes.Where(type => type.Boxed))
+		{
+			string typeFileName = $"Boxed{type.Name}_Generated";
+			string arrayFunction = $"static TArray<TScriptInterface<IBoxedType>> Box{type.Name}Array(";
+			string arrayParamIndent = new(' ', arrayFunction.Length);
+			umbrella.AppendLine($@"#include ""{typeFileName}.h""");
+
+			StringBuilder sb = new();
+			sb.AppendLine($@"
+// This file is automatically generated by BpValueBox.Build.cs. It will be overwritten during builds.
+// If you need to customize generation, modify BpValueBox.Build.cs instead.
+
+#pragma once
+
+#include ""StructUtils/InstancedStruct.h""
+#include ""BoxedValue.h""
+#include ""{typeFileName}.generated.h""
+
+UCLASS(BlueprintType)
+class BPVALUEBOX_API UBoxed{type.Name} final : public UObject, public IBoxedType
+{{
+	GENERATED_BODY()
+
+public:
+	static constexpr EValueType StaticType = EValueType::{type.Name};
+
+	UPROPERTY(BlueprintReadWrite, BlueprintSetter=SetValue)
+	{type.Type} Value = {type.Type}{{}};
+
+	UBoxed{type.Name}() {{ NativeType = StaticType; }}
+
+	// Blueprint writes go through here, since common values share one box, see FBoxedValueCache
+	UFUNCTION(BlueprintSetter)
+	void SetValue({type.Param} NewValue)
+	{{
+		if (FBoxedValueCache::CanWrite(this))
+		{{
+			Value = NewValue;
+		}}
+	}}
+
+	virtual EValueType GetType_Implementation() override {{ return StaticType; }}
+
+	virtual void ResetValue() override {{ Value = {type.Type}{{}}; }}
+
+	// Set bUnique when the box's Value is going to be changed, since common values share one box
+	UFUNCTION(BlueprintCallable, meta = ( DefaultToSelf = Context ), Category=""BoxedValue"")
+	static UBoxed{type.Name}* Box{type.Name}(UObject* Context, const {type.Type}& Input, const bool bUnique = false)
+	{{
+		return UBoxedValueStatics::BoxValue<UBoxed{type.Name}>(Context, Input, bUnique);
+	}}
+
+	UFUNCTION(BlueprintPure, Category=""BoxedValue"")
+	static {type.Type} As{type.Name}(const TScriptInterface<IBoxedType>& Input)
+	{{
+		return UBoxedValueStatics::GetValue<{type.Type}, UBoxed{type.Name}>(Input);
+	}}
+
+	UFUNCTION(BlueprintCallable, meta = ( ExpandBoolAsExecs = ""ReturnValue"" ), Category=""BoxedValue"")
+	static bool TryAs{type.Name}(const TScriptInterface<IBoxedType>& Input, {type.Type}& OutValue)
+	{{
+		return UBoxedValueStatics::TryUnbox<UBoxed{type.Name}>(Input, OutValue);
+	}}
+
+	// Boxes the whole array in one call, see UBoxedValueStatics::BoxArray
+	UFUNCTION(BlueprintCallable, meta = ( DefaultToSelf = Context ), Category=""BoxedValue"")
+	static TArray<TScriptInterface<IBoxedType>> Box{type.Name}Array(UObject* Context, const TArray<{type.Type}>& Input,
+	{arrayParamIndent}const bool bUnique = false)
+	{{
+		TArray<TScriptInterface<IBoxedType>> boxes;
+		UBoxedValueStatics::BoxArray<UBoxed{type.Name}>(Context, Input, boxes, bUnique);
+		return boxes;
+	}}
+
+	// Boxes of another kind come out as a default value
+	UFUNCTION(BlueprintPure, Category=""BoxedValue"")
+	static TArray<{type.Type}> As{type.Name}Array(const TArray<TScriptInterface<IBoxedType>>& Input)
+	{{
+		TArray<{type.Type}> values;
+		UBoxedValueStatics::UnboxArray<UBoxed{type.Name}>(Input, values);
+		return values;
+	}}
+}};");
+
+			WriteIfChanged(Path.Combine(publicDir, $"{typeFileName}.h"), sb.ToString());
+		}
+
+		WriteIfChanged(outPath, umbrella.ToString());
+	}
+
+	private void GenerateVariantTypes()
+	{
+		string publicDir = Path.Combine(ModuleDirectory, "Public");
+		Directory.CreateDirectory(publicDir);
+		string outPath = Path.Combine(publicDir, "BpVariantTypes_Generated.h");
 
 		StringBuilder sb = new();
 		sb.AppendLine(@"
@@ -125,51 +290,495 @@ public class BpValueBox : ModuleRules
 
 #pragma once
 
+#include ""CoreMinimal.h""
+#include ""Misc/TVariant.h""
 #include ""StructUtils/InstancedStruct.h""
-#include ""BoxedValue.h""
-#include ""BoxedValue_Generated.generated.h""
+#include ""ValueType.h""
+
+/*
+The EValueType reported for each arm. Arms that have no EValueType of their own report None.
+Any other type is a compile error, rather than quietly reporting None.
+*/
+template <typename Type>
+struct TBpVariantValueType
+{
+	static_assert(!std::is_same_v<Type, Type>, ""FBpVariant has no arm for this type"");
+};
+
+template <> struct TBpVariantValueType<FEmptyVariantState> { static constexpr EValueType Value = EValueType::None; };
+template <> struct TBpVariantValueType<FVariant> { static constexpr EValueType Value = EValueType::None; };
+");
+
+		foreach (ValueTypeInfo type in ValueTypes)
+		{
+			string specialization = $"template <> struct TBpVariantValueType<{type.Type}>";
+			string value = $"static constexpr EValueType Value = EValueType::{type.Name};";
+			sb.AppendLine(specialization.Length + value.Length < 112
+				? $"{specialization} {{ {value} }};"
+				: $"{specialization}\n{{\n\t{value}\n}};");
+		}
+		sb.AppendLine();
+
+		string types = string.Join(", ", ValueTypes.Select(type => type.Type));
+		sb.AppendLine($@"/*
+Every value FBpVariant can hold. Primitive and math types get their own arm so they live inline in the TVariant's
+aligned storage instead of being serialized into the heap buffer of an FVariant. The FVariant arm is only used for
+interop, when an FVariant holds a type that has no native arm.
+*/
+using FBpVariantStorage = TVariant<FEmptyVariantState, {types}, FVariant>;
+
+// The arm of every EValueType except None
+using FBpVariantValueTypes = TTuple<{types}>;
+
+// Expands X(Type, ValueType) for every type in FBpVariantValueTypes, for code that needs a case per type
+#define BPVARIANT_FOR_EACH_TYPE(X) \");
+		sb.AppendLine(string.Join(" \\\n", ValueTypes.Select(type => $"\tX({type.Type}, {type.Name})")));
+
+		WriteIfChanged(outPath, sb.ToString());
+	}
+
+	private void GenerateVariantStatics()
+	{
+		string publicDir = Path.Combine(ModuleDirectory, "Public");
+		Directory.CreateDirectory(publicDir);
+		string outPath = Path.Combine(publicDir, "BpVariant_Generated.h");
+
+		StringBuilder sb = new();
+		sb.AppendLine(@"
+// This file is automatically generated by BpValueBox.Build.cs. It will be overwritten during builds.
+// If you need to customize generation, modify BpValueBox.Build.cs instead.
+
+#pragma once
+
+#include ""BpVariant.h""
+#include ""BpVariant_Generated.generated.h""
+
+/* The Set, Get and MakeVariantFrom functions of every type, on top of the generic API in UBpVariantStaticsBase. */
+UCLASS()
+class BPVALUEBOX_API UBpVariantStatics : public UBpVariantStaticsBase
+{
+	GENERATED_BODY()
+
+public:");
+
+		foreach (ValueTypeInfo type in ValueTypes)
+		{
+			sb.AppendLine($@"	UFUNCTION(BlueprintCallable, Category=""BpVariant"")
+	static FBpVariant Set{type.FunctionName}(UPARAM(ref) FBpVariant& Variant, {type.Param} Value)
+	{{
+		return Assign(Variant, Value);
+	}}
+
+	// Blueprint getters are always checked, whatever DefaultAccess says
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category=""BpVariant"")
+	static {type.Type} Get{type.FunctionName}(const FBpVariant& Variant)
+	{{
+		return GetVariant<{type.Type}, EBpVariantAccess::Checked>(Variant);
+	}}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category=""BpVariant"")
+	static FBpVariant MakeVariantFrom{type.FunctionName}({type.Param} Value)
+	{{
+		return MakeFromGeneric(Value);
+	}}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category=""BpVariant"")
+	static TArray<FBpVariant> MakeVariantArrayFrom{type.FunctionName}(const TArray<{type.Type}>& Values)
+	{{
+		TArray<FBpVariant> variants;
+		BoxArray<{type.Type}>(Values, variants);
+		return variants;
+	}}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category=""BpVariant"")
+	static TArray<{type.Type}> Get{type.FunctionName}Array(const TArray<FBpVariant>& Variants)
+	{{
+		TArray<{type.Type}> values;
+		UnboxArray<{type.Type}, EBpVariantAccess::Checked>(Variants, values);
+		return values;
+	}}
+");
+		}
+
+		const string outputIndent = "\t                                ";
+		IEnumerable<string> outputs = ValueTypes.Select(type => $",\n{outputIndent}{type.Type}& {type.FunctionName}");
+		IEnumerable<string> lambdas = ValueTypes.Select(type =>
+			$"\t\t\t[&{type.FunctionName}]({type.Param} Value) {{ {type.FunctionName} = Value; }},\n");
+		sb.AppendLine($@"	// Fires the exec pin of the variant's type, with only that type's output filled in
+	UFUNCTION(BlueprintCallable, meta = ( ExpandEnumAsExecs = ""Type"" ), Category=""BpVariant"")
+	static void SwitchOnVariantType(const FBpVariant& Variant, EValueType& Type{string.Concat(outputs)})
+	{{
+		Type = Variant.GetType();
+		Visit(Variant, TBpVariantOverloads
+		{{
+{string.Concat(lambdas)}			// Empty variants and FVariants without a native arm go out of the None pin
+			[](const auto&) {{}},
+		}});
+	}}
+}};");
+
+		WriteIfChanged(outPath, sb.ToString());
+	}
+
+	private void GenerateVariantTypeTests()
+	{
+		string testsDir = Path.Combine(ModuleDirectory, "Tests");
+		Directory.CreateDirectory(testsDir);
+		string outPath = Path.Combine(testsDir, "BpVariantTypeTests_Generated.cpp");
+
+		StringBuilder sb = new();
+		sb.AppendLine(@"
+// This file is automatically generated by BpValueBox.Build.cs. It will be overwritten during builds.
+// If you need to customize generation, modify BpValueBox.Build.cs instead.
+
+#include ""Misc/AutomationTest.h""
+#include ""BpVariant_Generated.h""
+#include ""Serialization/MemoryReader.h""
+#include ""Serialization/MemoryWriter.h""
+#include ""Serialization/ObjectAndNameAsStringProxyArchive.h""
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(BpVariantTypeTests, ""Tests.BpVariantTypeTests"",
+                                  EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Variant is made from a type's sample value, and Copy by passing it through the type's getter and setter
+bool TestVariantType(FAutomationTestBase* Context, const FBpVariant& Variant, const FBpVariant& Copy,
+                     const EValueType Type)
+{
+	// Plain memory archives can't write objects, so they go through as paths
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	FObjectAndNameAsStringProxyArchive writerProxy(writer, false);
+	FBpVariant saved = Variant;
+	saved.Serialize(writerProxy);
+
+	FMemoryReader reader(bytes);
+	FObjectAndNameAsStringProxyArchive readerProxy(reader, false);
+	FBpVariant loaded;
+	loaded.Serialize(readerProxy);
+
+	const bool typeCorrect = UBpVariantStatics::GetType(Variant) == Type && UBpVariantStatics::GetType(Copy) == Type;
+	const bool copyCorrect = Copy == Variant && GetTypeHash(Copy) == GetTypeHash(Variant);
+	const bool loadCorrect = loaded == Variant && GetTypeHash(loaded) == GetTypeHash(Variant);
+
+	Context->TestTrue(TEXT(""The variant should report the type it was made from""), typeCorrect);
+	Context->TestTrue(TEXT(""The getter and setter should keep the value""), copyCorrect);
+	Context->TestTrue(TEXT(""Serializing should keep the value and hash""), loadCorrect);
+
+	return typeCorrect && copyCorrect && loadCorrect;
+}
+");
+
+		foreach (ValueTypeInfo type in ValueTypes)
+		{
+			sb.AppendLine($@"const FString BpVariantTypeTests_{type.Name} = TEXT(""BpVariantTypeTests_{type.Name}"");");
+		}
+
+		sb.AppendLine(@"
+void BpVariantTypeTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FString> tests =
+	{");
+		foreach (ValueTypeInfo type in ValueTypes)
+		{
+			sb.AppendLine($"\t\tBpVariantTypeTests_{type.Name},");
+		}
+		sb.AppendLine(@"	};
+
+	for (const FString& test : tests)
+	{
+		OutBeautifiedNames.Add(test);
+		OutTestCommands.Add(test);
+	}
+}
+
+bool BpVariantTypeTests::RunTest(const FString& Parameters)
+{
+	TMap<FString, TFunction<bool()>> tests =
+	{");
+		foreach (ValueTypeInfo type in ValueTypes)
+		{
+			sb.AppendLine($@"		{{
+			BpVariantTypeTests_{type.Name},
+			[this]()
+			{{
+				const FBpVariant variant = UBpVariantStatics::MakeVariantFrom{type.FunctionName}({type.Sample});
+				FBpVariant copy;
+				UBpVariantStatics::Set{type.FunctionName}(copy, UBpVariantStatics::Get{type.FunctionName}(variant));
+				return TestVariantType(this, variant, copy, EValueType::{type.Name});
+			}}
+		}},");
+		}
+		sb.AppendLine(@"	};
+
+	if (tests.Contains(Parameters))
+	{
+		return tests[Parameters]();
+	}
+	return true;
+}");
+
+		WriteIfChanged(outPath, sb.ToString());
+	}
+
+	private void GenerateVariantTupleTypes()
+	{
+		string publicDir = Path.Combine(ModuleDirectory, "Public");
+		Directory.CreateDirectory(publicDir);
+		string outPath = Path.Combine(publicDir, "BpVariantTuple_Generated.h");
+
+		const int minElements = 2;
+		const int maxElements = 16;
+
+		StringBuilder sb = new();
+		sb.AppendLine(@"
+// This file is automatically generated by BpValueBox.Build.cs. It will be overwritten during builds.
+// If you need to customize generation, modify BpValueBox.Build.cs instead.
+
+#pragma once
+
+#include ""Kismet/BlueprintFunctionLibrary.h""
+#include ""BpVariantTuple.h""
+#include ""BpVariantTuple_Generated.generated.h""
 ");
 
-		foreach (var type in types)
+		for (int n = minElements; n <= maxElements; n++)
 		{
 			sb.AppendLine($@"
-UCLASS(Blueprintable)
-class BPVALUEBOX_API UBoxed{type.name} : public UObject, public IBoxedType
+/* {n} variants stored inline. Their types are packed into a signature that checks them all at once. */
+USTRUCT(BlueprintType, meta = ( HasNativeMake = ""/Script/BpValueBox.BpVariantTupleStatics.MakeVariantTuple{n}"",
+	HasNativeBreak = ""/Script/BpValueBox.BpVariantTupleStatics.BreakVariantTuple{n}"" ))
+struct BPVALUEBOX_API FBpVariantTuple{n}
 {{
 	GENERATED_BODY()
 
-public:
-	UPROPERTY(BlueprintReadWrite)
-	{type.type} Value = {type.type}{{}};
+	static constexpr int32 Num = {n};
 
-	virtual EValueType GetType_Implementation() override {{ return EValueType::{type.name}; }}
+	const FBpVariant& Get(const int32 Index) const
+	{{
+		check(Index >= 0 && Index < Num);
+		return Elements[Index];
+	}}
 
-	UFUNCTION(BlueprintCallable, meta = ( DefaultToSelf = Context ), Category=""BoxedValue"")
-	static UBoxed{type.name}* Box{type.name}(UObject* Context, const {type.type}& Input)
+	void Set(const int32 Index, const FBpVariant& Value)
 	{{
-		return UBoxedValueStatics::BoxValue<UBoxed{type.name}>(Context, Input);
+		check(Index >= 0 && Index < Num);
+		Elements[Index] = Value;
+		Signature.Set(Index, Value.GetType());
 	}}
 
-	UFUNCTION(BlueprintPure, Category=""BoxedValue"")
-	static {type.type} As{type.name}(const TScriptInterface<IBoxedType>& Input)
+	const TBpVariantTupleSignature<Num>& GetSignature() const
+	{{
+		return Signature;
+	}}
+
+	// Whether the elements hold these C++ types, in order
+	template <typename... Types>
+	bool Matches() const
+	{{
+		return GetSignature() == TBpVariantTupleSignature<Num>::template Make<Types...>();
+	}}
+
+	void PostSerialize(const FArchive& Ar)
+	{{
+		if (Ar.IsLoading())
+		{{
+			UpdateSignature();
+		}}
+	}}
+
+	// Replicates the elements only, the signature is rebuilt from them on the receiving end
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
 	{{
-		return UBoxedValueStatics::GetValue<{type.type}, UBoxed{type.name}>(Input);
+		bOutSuccess = true;
+		for (FBpVariant& element : Elements)
+		{{
+			bool bElementSuccess = true;
+			element.NetSerialize(Ar, Map, bElementSuccess);
+			bOutSuccess &= bElementSuccess;
+		}}
+		if (Ar.IsLoading())
+		{{
+			UpdateSignature();
+		}}
+		return true;
 	}}
+
+private:
+	// Loading and replication write the elements without going through Set, so they rebuild it from the live arms
+	void UpdateSignature()
+	{{
+		for (int32 i = 0; i < Num; ++i)
+		{{
+			Signature.Set(i, Elements[i].GetType());
+		}}
+	}}
+
+	UPROPERTY()
+	FBpVariant Elements[{n}];
+
+	TBpVariantTupleSignature<Num> Signature;
+}};
+
+template <>
+struct TStructOpsTypeTraits<FBpVariantTuple{n}> : public TStructOpsTypeTraitsBase2<FBpVariantTuple{n}>
+{{
+	enum
+	{{
+		WithPostSerialize = true,
+		WithNetSerializer = true,
+	}};
 }};
 ");
 		}
-		
-		string newContents = sb.ToString();
-		bool needWrite = true;
-		if (File.Exists(outPath))
+
+		sb.AppendLine(@"
+UCLASS()
+class BPVALUEBOX_API UBpVariantTupleStatics : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:");
+
+		for (int n = minElements; n <= maxElements; n++)
 		{
-			string existing = File.ReadAllText(outPath);
-			needWrite = existing != newContents;
+			List<string> inputs = new();
+			List<string> outputs = new();
+			StringBuilder sets = new();
+			StringBuilder gets = new();
+			for (int i = 0; i < n; i++)
+			{
+				inputs.Add($"const FBpVariant& Element{i}");
+				outputs.Add($"FBpVariant& Element{i}");
+				sets.Append($"\t\ttuple.Set({i}, Element{i});\n");
+				gets.Append($"\t\tElement{i} = Tuple.Get({i});\n");
+			}
+
+			sb.AppendLine($@"
+	UFUNCTION(BlueprintPure, meta = ( NativeMakeFunc ), Category=""BpVariant|Tuple"")
+	static FBpVariantTuple{n} MakeVariantTuple{n}({string.Join(", ", inputs)})
+	{{
+		FBpVariantTuple{n} tuple;
+{sets}		return tuple;
+	}}
+
+	UFUNCTION(BlueprintPure, meta = ( NativeBreakFunc ), Category=""BpVariant|Tuple"")
+	static void BreakVariantTuple{n}(const FBpVariantTuple{n}& Tuple, {string.Join(", ", outputs)})
+	{{
+{gets}	}}
+
+	UFUNCTION(BlueprintPure, Category=""BpVariant|Tuple"")
+	static FBpVariant GetVariantTuple{n}Element(const FBpVariantTuple{n}& Tuple, const int32 Index)
+	{{
+		return Index >= 0 && Index < FBpVariantTuple{n}::Num ? Tuple.Get(Index) : FBpVariant();
+	}}
+
+	UFUNCTION(BlueprintCallable, Category=""BpVariant|Tuple"")
+	static void SetVariantTuple{n}Element(UPARAM(ref) FBpVariantTuple{n}& Tuple, const int32 Index,
+	                                      const FBpVariant& Value)
+	{{
+		if (Index >= 0 && Index < FBpVariantTuple{n}::Num)
+		{{
+			Tuple.Set(Index, Value);
+		}}
+	}}
+
+	UFUNCTION(BlueprintPure, Category=""BpVariant|Tuple"")
+	static EValueType GetVariantTuple{n}Type(const FBpVariantTuple{n}& Tuple, const int32 Index)
+	{{
+		return Index >= 0 && Index < FBpVariantTuple{n}::Num ? Tuple.GetSignature().Get(Index) : EValueType::None;
+	}}
+
+	// Compares the types of every element at once
+	UFUNCTION(BlueprintPure, Category=""BpVariant|Tuple"")
+	static bool VariantTuple{n}TypesMatch(const FBpVariantTuple{n}& A, const FBpVariantTuple{n}& B)
+	{{
+		return A.GetSignature() == B.GetSignature();
+	}}");
 		}
 
-		if (needWrite)
+		sb.AppendLine("};");
+
+		WriteIfChanged(outPath, sb.ToString());
+	}
+
+	// EValueType isn't generated, since its values are saved and must never be renumbered by a table change
+	private void CheckValueTypesAreDeclared()
+	{
+		string valueTypePath = Path.Combine(ModuleDirectory, "Public", "ValueType.h");
+		string contents = File.ReadAllText(valueTypePath);
+		Match enumBody = Regex.Match(contents, @"enum\s+class\s+EValueType\s*:\s*uint8\s*\{(?<body>[^}]*)\}");
+		if (!enumBody.Success)
 		{
-			File.WriteAllText(outPath, newContents, Encoding.UTF8);
+			throw new BuildException($"Couldn't find the EValueType enum in {valueTypePath}.");
+		}
+
+		HashSet<string> declared = Regex.Matches(enumBody.Groups["body"].Value, @"^\s*(?<name>\w+)\b",
+				RegexOptions.Multiline)
+			.Select(match => match.Groups["name"].Value)
+			.ToHashSet();
+		foreach (ValueTypeInfo info in ValueTypes.Where(info => !declared.Contains(info.Name)))
+		{
+			throw new BuildException($"EValueType::{info.Name} is missing from ValueType.h. Add it at the end of " +
+				"EValueType, after None, since saved variants store its value.");
+		}
+	}
+
+	// Only touches the file when it changes, so builds don't recompile everything that includes it
+	private void WriteIfChanged(string outPath, string newContents)
+	{
+		string relativePath = Path.GetRelativePath(ModuleDirectory, outPath);
+		string hash = Convert.ToHexString(SHA256.HashData(Encoding.UTF8.GetBytes(newContents)));
+		GeneratedHashes[relativePath] = hash;
+
+		// The file on disk is always checked, since it can be edited or restored by hand after the manifest was saved
+		if (File.Exists(outPath) && File.ReadAllText(outPath) == newContents)
+		{
+			return;
+		}
+
+		File.WriteAllText(outPath, newContents, Encoding.UTF8);
+	}
+
+	// A missing or unreadable manifest only means files left over from an earlier table aren't deleted
+	private void LoadManifest()
+	{
+		if (!File.Exists(ManifestPath))
+		{
+			return;
+		}
+
+		foreach (string line in File.ReadAllLines(ManifestPath))
+		{
+			string[] parts = line.Split(' ', 2);
+			if (parts.Length == 2)
+			{
+				PreviousHashes[parts[1]] = parts[0];
+			}
+		}
+	}
+
+	private void SaveManifest()
+	{
+		IEnumerable<string> lines = GeneratedHashes.OrderBy(entry => entry.Key, StringComparer.Ordinal)
+			.Select(entry => $"{entry.Value} {entry.Key}");
+		string contents = string.Join("\n", lines) + "\n";
+		if (!File.Exists(ManifestPath) || File.ReadAllText(ManifestPath) != contents)
+		{
+			Directory.CreateDirectory(Path.GetDirectoryName(ManifestPath));
+			File.WriteAllText(ManifestPath, contents);
+		}
+	}
+
+	// Removes the files of types that were taken out of the table, so nothing keeps including a stale header
+	private void DeleteStaleFiles()
+	{
+		foreach (string relativePath in PreviousHashes.Keys.Where(path => !GeneratedHashes.ContainsKey(path)))
+		{
+			string stalePath = Path.Combine(ModuleDirectory, relativePath);
+			if (File.Exists(stalePath))
+			{
+				File.Delete(stalePath);
+			}
 		}
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,41 @@
+#include "BoxedValue.h"
+
+#include "BoxedValuePool.h"
+
+UObject* UBoxedValueStatics::AcquireBox(UObject* Context, UClass* BoxClass)
+{
+	if (UBoxedValuePool* pool = UBoxedValuePool::Get(Context))
+	{
+		return pool->Acquire(BoxClass);
+	}
+	return NewObject<UObject>(Context, BoxClass);
+}
+
+void UBoxedValueStatics::AcquireBoxes(UObject* Context, UClass* BoxClass, const TArrayView<UObject*> OutBoxes)
+{
+	if (UBoxedValuePool* pool = UBoxedValuePool::Get(Context))
+	{
+		pool->AcquireMany(BoxClass, OutBoxes);
+		return;
+	}
+	for (UObject*& box : OutBoxes)
+	{
+		box = NewObject<UObject>(Context, BoxClass);
+	}
+}
+
+void UBoxedValueStatics::ReleaseBox(UObject* Context, const TScriptInterface<IBoxedType>& Box)
+{
+	if (UBoxedValuePool* pool = UBoxedValuePool::Get(Context))
+	{
+		pool->Release(Box.GetObject());
+	}
+}
+
+void UBoxedValueStatics::ReleaseBoxAtEndOfFrame(UObject* Context, const TScriptInterface<IBoxedType>& Box)
+{
+	if (UBoxedValuePool* pool = UBoxedValuePool::Get(Context))
+	{
+		pool->ReleaseAtEndOfFrame(Box.GetObject());
+	}
+}
@@ -0,0 +1,195 @@
+#include "BoxedValueCache.h"
+
+#include "BoxedBool_Generated.h"
+#include "BoxedByte_Generated.h"
+#include "BoxedFloat32_Generated.h"
+#include "BoxedFloat64_Generated.h"
+#include "BoxedInt32_Generated.h"
+#include "BoxedInt64_Generated.h"
+#include "BoxedName_Generated.h"
+#include "BoxedRotator_Generated.h"
+#include "BoxedString_Generated.h"
+#include "BoxedVector_Generated.h"
+#include "BpValueBox.h"
+#include "BpValueBoxSettings.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace
+{
+	constexpr int32 NumCachedIntegers = FBoxedValueCache::MaxCachedInteger - FBoxedValueCache::MinCachedInteger + 1;
+
+	UObject* BoxedBools[2];
+	UObject* BoxedBytes[256];
+	UObject* BoxedInt32s[NumCachedIntegers];
+	UObject* BoxedInt64s[NumCachedIntegers];
+	UObject* BoxedFloat32Zero;
+	UObject* BoxedFloat64Zero;
+	UObject* BoxedNameNone;
+	UObject* BoxedEmptyString;
+	UObject* BoxedZeroVector;
+	UObject* BoxedZeroRotator;
+
+	// Every box above that has been created. Only written on the game thread, but any thread can ask.
+	TSet<const UObject*> InternedBoxes;
+	FRWLock InternedBoxesLock;
+
+	bool IsCachedInteger(const int64 Value)
+	{
+		return Value >= FBoxedValueCache::MinCachedInteger && Value <= FBoxedValueCache::MaxCachedInteger;
+	}
+
+	// Boxes are created on first use. That needs the game thread, so other threads fall through to a plain box
+	// of their own (see UBoxedValuePool::Get).
+	template <typename TBoxType, typename TValueType>
+	UObject* FindOrCreate(const UClass* BoxClass, UObject*& Slot, const TValueType& Value)
+	{
+		if (BoxClass != TBoxType::StaticClass() || !IsInGameThread())
+		{
+			return nullptr;
+		}
+		if (!Slot)
+		{
+			TBoxType* box = NewObject<TBoxType>(GetTransientPackage());
+			box->Value = Value;
+			box->AddToRoot();
+			FWriteScopeLock lock(InternedBoxesLock);
+			InternedBoxes.Add(box);
+			Slot = box;
+		}
+		return Slot;
+	}
+}
+
+bool FBoxedValueCache::IsEnabled()
+{
+	return GetDefault<UBpValueBoxSettings>()->bInternCommonValues;
+}
+
+bool FBoxedValueCache::IsInterned(const UObject* Box)
+{
+	if (!Box)
+	{
+		return false;
+	}
+	FReadScopeLock lock(InternedBoxesLock);
+	return InternedBoxes.Contains(Box);
+}
+
+bool FBoxedValueCache::CanWrite(const UObject* Box)
+{
+	if (IsInterned(Box))
+	{
+		UE_LOG(LogBpValueBox, Warning, TEXT("%s is a shared box and can't be changed, box the value with bUnique set"),
+		       *Box->GetName());
+		return false;
+	}
+	return true;
+}
+
+void FBoxedValueCache::Reset()
+{
+	FWriteScopeLock lock(InternedBoxesLock);
+	// The boxes are already gone if the object system has shut down first
+	if (UObjectInitialized())
+	{
+		for (const UObject* box : InternedBoxes)
+		{
+			const_cast<UObject*>(box)->RemoveFromRoot();
+		}
+	}
+	InternedBoxes.Reset();
+
+	FMemory::Memzero(BoxedBools);
+	FMemory::Memzero(BoxedBytes);
+	FMemory::Memzero(BoxedInt32s);
+	FMemory::Memzero(BoxedInt64s);
+	BoxedFloat32Zero = nullptr;
+	BoxedFloat64Zero = nullptr;
+	BoxedNameNone = nullptr;
+	BoxedEmptyString = nullptr;
+	BoxedZeroVector = nullptr;
+	BoxedZeroRotator = nullptr;
+}
+
+UObject* FBoxedValueCache::Find(const UClass* BoxClass, const bool Value)
+{
+	return FindOrCreate<UBoxedBool>(BoxClass, BoxedBools[Value ? 1 : 0], Value);
+}
+
+UObject* FBoxedValueCache::Find(const UClass* BoxClass, const uint8 Value)
+{
+	return FindOrCreate<UBoxedByte>(BoxClass, BoxedBytes[Value], Value);
+}
+
+UObject* FBoxedValueCache::Find(const UClass* BoxClass, const int32 Value)
+{
+	if (!IsCachedInteger(Value))
+	{
+		return nullptr;
+	}
+	return FindOrCreate<UBoxedInt32>(BoxClass, BoxedInt32s[Value - MinCachedInteger], Value);
+}
+
+UObject* FBoxedValueCache::Find(const UClass* BoxClass, const int64 Value)
+{
+	if (!IsCachedInteger(Value))
+	{
+		return nullptr;
+	}
+	return FindOrCreate<UBoxedInt64>(BoxClass, BoxedInt64s[Value - MinCachedInteger], Value);
+}
+
+UObject* FBoxedValueCache::Find(const UClass* BoxClass, const float Value)
+{
+	// Compare the bits so -0.0 doesn't come back as 0.0
+	if (FMath::AsUInt(Value) != 0)
+	{
+		return nullptr;
+	}
+	return FindOrCreate<UBoxedFloat32>(BoxClass, BoxedFloat32Zero, Value);
+}
+
+UObject* FBoxedValueCache::Find(const UClass* BoxClass, const double Value)
+{
+	if (FMath::AsUInt(Value) != 0)
+	{
+		return nullptr;
+	}
+	return FindOrCreate<UBoxedFloat64>(BoxClass, BoxedFloat64Zero, Value);
+}
+
+UObject* FBoxedValueCache::Find(const UClass* BoxClass, const FName& Value)
+{
+	if (!Value.IsNone())
+	{
+		return nullptr;
+	}
+	return FindOrCreate<UBoxedName>(BoxClass, BoxedNameNone, Value);
+}
+
+UObject* FBoxedValueCache::Find(const UClass* BoxClass, const FString& Value)
+{
+	if (!Value.IsEmpty())
+	{
+		return nullptr;
+	}
+	return FindOrCreate<UBoxedString>(BoxClass, BoxedEmptyString, Value);
+}
+
+UObject* FBoxedValueCache::Find(const UClass* BoxClass, const FVector& Value)
+{
+	if (Value != FVector::ZeroVector)
+	{
+		return nullptr;
+	}
+	return FindOrCreate<UBoxedVector>(BoxClass, BoxedZeroVector, Value);
+}
+
+UObject* FBoxedValueCache::Find(const UClass* BoxClass, const FRotator& Value)
+{
+	if (Value != FRotator::ZeroRotator)
+	{
+		return nullptr;
+	}
+	return FindOrCreate<UBoxedRotator>(BoxClass, BoxedZeroRotator, Value);
+}
@@ -0,0 +1,127 @@
+#include "BoxedValuePool.h"
+
+#include "BoxedValueCache.h"
+#include "BpValueBox.h"
+#include "BpValueBoxSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+UBoxedValuePool* UBoxedValuePool::Get(const UObject* Context)
+{
+	// Nothing in the pool is synchronized, so other threads make plain boxes and never release them
+	if (!GEngine || !Context || !IsInGameThread())
+	{
+		return nullptr;
+	}
+	const UWorld* world = GEngine->GetWorldFromContextObject(Context, EGetWorldErrorMode::ReturnNull);
+	return world ? world->GetSubsystem<UBoxedValuePool>() : nullptr;
+}
+
+void UBoxedValuePool::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(
+		this, &UBoxedValuePool::HandleWorldPostActorTick);
+}
+
+void UBoxedValuePool::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	FrameBoxes.Empty();
+	Buckets.Empty();
+	PooledBoxes.Empty();
+	Super::Deinitialize();
+}
+
+UObject* UBoxedValuePool::Acquire(UClass* BoxClass)
+{
+	check(BoxClass && IsInGameThread());
+	if (FBoxedValuePoolBucket* bucket = Buckets.Find(BoxClass))
+	{
+		if (!bucket->Boxes.IsEmpty())
+		{
+			UObject* box = bucket->Boxes.Pop(EAllowShrinking::No);
+			PooledBoxes.Remove(box);
+			return box;
+		}
+	}
+	return NewObject<UObject>(this, BoxClass);
+}
+
+void UBoxedValuePool::AcquireMany(UClass* BoxClass, const TArrayView<UObject*> OutBoxes)
+{
+	check(BoxClass && IsInGameThread());
+	int32 numReused = 0;
+	if (FBoxedValuePoolBucket* bucket = Buckets.Find(BoxClass))
+	{
+		numReused = FMath::Min(bucket->Boxes.Num(), OutBoxes.Num());
+		const int32 firstReused = bucket->Boxes.Num() - numReused;
+		for (int32 i = 0; i < numReused; ++i)
+		{
+			OutBoxes[i] = bucket->Boxes[firstReused + i];
+			PooledBoxes.Remove(OutBoxes[i]);
+		}
+		bucket->Boxes.SetNum(firstReused, EAllowShrinking::No);
+	}
+
+	for (int32 i = numReused; i < OutBoxes.Num(); ++i)
+	{
+		OutBoxes[i] = NewObject<UObject>(this, BoxClass);
+	}
+}
+
+void UBoxedValuePool::Release(UObject* Box)
+{
+	check(IsInGameThread());
+	// Blueprint implementations of IBoxedType have no native value to reset, so they are left to the GC
+	IBoxedType* boxedType = Cast<IBoxedType>(Box);
+	if (!boxedType || FBoxedValueCache::IsInterned(Box))
+	{
+		return;
+	}
+	if (PooledBoxes.Contains(Box))
+	{
+		UE_LOG(LogBpValueBox, Warning, TEXT("%s was released to the box pool twice"), *Box->GetName());
+		return;
+	}
+
+	FBoxedValuePoolBucket& bucket = Buckets.FindOrAdd(Box->GetClass());
+	if (bucket.Boxes.Num() >= GetDefault<UBpValueBoxSettings>()->MaxPooledBoxesPerClass)
+	{
+		return;
+	}
+
+	// Resetting here rather than on reuse stops pooled boxes from keeping their old values alive
+	boxedType->ResetValue();
+	bucket.Boxes.Add(Box);
+	PooledBoxes.Add(Box);
+}
+
+void UBoxedValuePool::ReleaseAtEndOfFrame(UObject* Box)
+{
+	check(IsInGameThread());
+	if (Box)
+	{
+		FrameBoxes.Add(Box);
+	}
+}
+
+int32 UBoxedValuePool::GetNumPooled(const UClass* BoxClass) const
+{
+	const FBoxedValuePoolBucket* bucket = Buckets.Find(BoxClass);
+	return bucket ? bucket->Boxes.Num() : 0;
+}
+
+void UBoxedValuePool::HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || FrameBoxes.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<TObjectPtr<UObject>> boxes = MoveTemp(FrameBoxes);
+	for (UObject* box : boxes)
+	{
+		Release(box);
+	}
+}
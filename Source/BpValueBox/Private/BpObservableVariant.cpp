@@ -0,0 +1,159 @@
+#include "BpObservableVariant.h"
+
+bool FBpObservableVariant::Set(const FBpVariant& NewValue, const uint64 NewVersion)
+{
+	if (Value == NewValue)
+	{
+		return false;
+	}
+	Value = NewValue;
+	Version = NewVersion;
+	return true;
+}
+
+FBpVariant& FBpObservableVariant::Modify(const uint64 NewVersion)
+{
+	Version = NewVersion;
+	return Value;
+}
+
+void FBpObservableVariant::PostSerialize(const FArchive& Ar)
+{
+	if (Ar.IsLoading())
+	{
+		++Version;
+	}
+}
+
+void FBpObservableVariantList::SetNum(const int32 NewNum)
+{
+	const int32 oldNum = Slots.Num();
+	Slots.SetNum(NewNum);
+	DirtyBits.SetNum(NewNum, false);
+	if (NewNum < oldNum)
+	{
+		++Version;
+	}
+	for (int32 i = oldNum; i < NewNum; ++i)
+	{
+		Slots[i].Modify(Version + 1);
+		RecordChange(i);
+	}
+}
+
+bool FBpObservableVariantList::Set(const int32 Index, const FBpVariant& Value)
+{
+	check(Slots.IsValidIndex(Index));
+	if (!Slots[Index].Set(Value, Version + 1))
+	{
+		return false;
+	}
+	RecordChange(Index);
+	return true;
+}
+
+FBpVariant& FBpObservableVariantList::Modify(const int32 Index)
+{
+	check(Slots.IsValidIndex(Index));
+	FBpVariant& value = Slots[Index].Modify(Version + 1);
+	RecordChange(Index);
+	return value;
+}
+
+void FBpObservableVariantList::RecordChange(const int32 Index)
+{
+	++Version;
+	Journal.Add({Index, Version});
+	DirtyBits[Index] = true;
+
+	// Dropping the replaced entries once they outnumber the slots keeps the journal at most a few entries per slot
+	if (Journal.Num() > FMath::Max(Slots.Num() * 2, 32))
+	{
+		Journal.RemoveAll([this](const FChange& Change)
+		{
+			return Change.Slot >= Slots.Num() || Slots[Change.Slot].GetVersion() != Change.Version;
+		});
+	}
+}
+
+TArray<int32> FBpObservableVariantList::GetChangedSince(const uint64 SinceVersion) const
+{
+	TArray<int32> indices;
+	ForEachChangedSince(SinceVersion, [&indices](const int32 Index, const FBpVariant&)
+	{
+		indices.Add(Index);
+	});
+	return indices;
+}
+
+void FBpObservableVariantList::ClearDirty()
+{
+	DirtyBits.SetRange(0, DirtyBits.Num(), false);
+}
+
+bool FBpObservableVariantList::SerializeDelta(FArchive& Ar, uint64& InOutVersion)
+{
+	if (Ar.IsSaving())
+	{
+		uint32 num = Slots.Num();
+		TArray<int32> changed = GetChangedSince(InOutVersion);
+		uint32 numChanged = changed.Num();
+		Ar << Version;
+		Ar.SerializeIntPacked(num);
+		Ar.SerializeIntPacked(numChanged);
+		for (const int32 index : changed)
+		{
+			uint32 slot = index;
+			Ar.SerializeIntPacked(slot);
+			// Saving only reads the variant
+			FBpVariant value = Slots[index].Get();
+			value.Serialize(Ar);
+		}
+		InOutVersion = Version;
+		return !Ar.IsError();
+	}
+
+	uint64 version = 0;
+	uint32 num = 0;
+	uint32 numChanged = 0;
+	Ar << version;
+	Ar.SerializeIntPacked(num);
+	Ar.SerializeIntPacked(numChanged);
+	if (Ar.IsError() || num > MaxDeltaSlots || numChanged > num)
+	{
+		Ar.SetError();
+		return false;
+	}
+
+	SetNum(num);
+	for (uint32 i = 0; i < numChanged && !Ar.IsError(); ++i)
+	{
+		uint32 slot = 0;
+		Ar.SerializeIntPacked(slot);
+		FBpVariant value;
+		value.Serialize(Ar);
+		if (slot >= num)
+		{
+			Ar.SetError();
+			break;
+		}
+		Set(slot, value);
+	}
+
+	InOutVersion = version;
+	return !Ar.IsError();
+}
+
+void FBpObservableVariantList::PostSerialize(const FArchive& Ar)
+{
+	if (!Ar.IsLoading())
+	{
+		return;
+	}
+	DirtyBits.SetNum(Slots.Num(), false);
+	for (int32 i = 0; i < Slots.Num(); ++i)
+	{
+		Slots[i].Modify(Version + 1);
+		RecordChange(i);
+	}
+}
@@ -2,8 +2,12 @@
 
 #include "BpValueBox.h"
 
+#include "BoxedValueCache.h"
+
 #define LOCTEXT_NAMESPACE "FBpValueBoxModule"
 
+DEFINE_LOG_CATEGORY(LogBpValueBox);
+
 void FBpValueBoxModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
@@ -13,6 +17,7 @@ void FBpValueBoxModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FBoxedValueCache::Reset();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,332 @@
+#include "BpVariant.h"
+
+#include "BpValueBox.h"
+#include "BpValueBoxSettings.h"
+#include "Engine/NetSerialization.h"
+#include "Serialization/CustomVersion.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("BpValueBox"), STATGROUP_BpValueBox, STATCAT_Advanced);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Variant Type Mismatches"), STAT_BpVariantTypeMismatches, STATGROUP_BpValueBox);
+
+const FGuid FBpVariantCustomVersion::GUID(0x6A3F2C91, 0x4E8B47D2, 0x9C15B7E0, 0x83D4F6A5);
+FCustomVersionRegistration GRegisterBpVariantCustomVersion(FBpVariantCustomVersion::GUID,
+	FBpVariantCustomVersion::LatestVersion, TEXT("BpVariant"));
+
+namespace
+{
+	// Kept outside of stats so it's also counted in builds without them
+	std::atomic<uint32> NumTypeMismatches = 0;
+
+	// Tag for the FVariant interop arm, which has no EValueType of its own.
+	// The other tags are EValueType values, so new EValueTypes go at the end of EValueType, after None,
+	// to keep old saves loading.
+	constexpr uint8 FVariantTag = 0xFF;
+
+	// Zigzag encodes the value so small negative numbers stay small, then writes 7 bits per byte
+	void SerializeVarInt(FArchive& Ar, int64& Value)
+	{
+		if (Ar.IsLoading())
+		{
+			uint64 zigZag = 0;
+			uint8 byte = 0;
+			int32 shift = 0;
+			do
+			{
+				Ar << byte;
+				zigZag |= static_cast<uint64>(byte & 0x7F) << shift;
+				shift += 7;
+			}
+			while ((byte & 0x80) != 0 && shift < 64 && !Ar.IsError());
+			Value = static_cast<int64>(zigZag >> 1) ^ -static_cast<int64>(zigZag & 1);
+			return;
+		}
+
+		uint64 zigZag = (static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63);
+		do
+		{
+			uint8 byte = zigZag & 0x7F;
+			zigZag >>= 7;
+			if (zigZag != 0)
+			{
+				byte |= 0x80;
+			}
+			Ar << byte;
+		}
+		while (zigZag != 0);
+	}
+
+	// When loading, switches the variant to the arm being read. Either way, returns that arm for serializing.
+	template <typename Type>
+	Type& SerializeArm(FBpVariant& Variant, FArchive& Ar)
+	{
+		if (Ar.IsLoading() && !Variant.Data.IsType<Type>())
+		{
+			Variant.Data.Emplace<Type>();
+		}
+		return Variant.Data.Get<Type>();
+	}
+
+	struct FSerializeContext
+	{
+		UPackageMap* Map = nullptr;
+		bool bNet = false;
+		bool bSuccess = true;
+	};
+
+	// How each type's value is written. Types without an overload here use their own operator<<.
+	template <typename Type>
+	void SerializeValue(Type& Value, FArchive& Ar, FSerializeContext&)
+	{
+		// Archives map names to indices, the name table when saving and the package map when replicating
+		Ar << Value;
+	}
+
+	void SerializeValue(bool& Value, FArchive& Ar, FSerializeContext&)
+	{
+		// FArchive writes bools as 32 bits
+		uint8 byte = Value ? 1 : 0;
+		Ar << byte;
+		Value = byte != 0;
+	}
+
+	template <typename Type>
+	void SerializeInteger(Type& Value, FArchive& Ar)
+	{
+		int64 wide = Value;
+		SerializeVarInt(Ar, wide);
+		Value = static_cast<Type>(wide);
+	}
+
+	void SerializeValue(int32& Value, FArchive& Ar, FSerializeContext&)
+	{
+		SerializeInteger(Value, Ar);
+	}
+
+	void SerializeValue(int64& Value, FArchive& Ar, FSerializeContext&)
+	{
+		SerializeInteger(Value, Ar);
+	}
+
+	void SerializeValue(FVector& Value, FArchive& Ar, FSerializeContext& Context)
+	{
+		if (!Context.bNet)
+		{
+			Ar << Value;
+			return;
+		}
+		switch (GetDefault<UBpValueBoxSettings>()->VectorQuantization)
+		{
+		case EBpVariantVectorQuantization::Whole:
+			SerializePackedVector<1, 24>(Value, Ar);
+			break;
+		case EBpVariantVectorQuantization::OneDecimal:
+			SerializePackedVector<10, 27>(Value, Ar);
+			break;
+		case EBpVariantVectorQuantization::TwoDecimals:
+			SerializePackedVector<100, 30>(Value, Ar);
+			break;
+		default:
+			Ar << Value;
+			break;
+		}
+	}
+
+	void SerializeValue(FRotator& Value, FArchive& Ar, FSerializeContext& Context)
+	{
+		if (Context.bNet && GetDefault<UBpValueBoxSettings>()->bCompressRotators)
+		{
+			Value.SerializeCompressedShort(Ar);
+			return;
+		}
+		Ar << Value;
+	}
+
+	void SerializeValue(FInstancedStruct& Value, FArchive& Ar, FSerializeContext& Context)
+	{
+		if (Context.bNet)
+		{
+			Value.NetSerialize(Ar, Context.Map, Context.bSuccess);
+		}
+		else
+		{
+			Value.Serialize(Ar);
+		}
+	}
+
+	void SerializeValue(UClass*& Value, FArchive& Ar, FSerializeContext&)
+	{
+		UObject* object = Value;
+		Ar << object;
+		Value = Cast<UClass>(object);
+	}
+
+	bool SerializeVariant(FBpVariant& Variant, FArchive& Ar, UPackageMap* Map, const bool bNet)
+	{
+		uint8 tag = Variant.Data.IsType<FVariant>() ? FVariantTag : static_cast<uint8>(Variant.GetType());
+		Ar << tag;
+
+		FSerializeContext context{Map, bNet};
+		switch (tag)
+		{
+#define BPVARIANT_SERIALIZE_CASE(Type, ValueType) \
+		case static_cast<uint8>(EValueType::ValueType): \
+			SerializeValue(SerializeArm<Type>(Variant, Ar), Ar, context); \
+			break;
+		BPVARIANT_FOR_EACH_TYPE(BPVARIANT_SERIALIZE_CASE)
+#undef BPVARIANT_SERIALIZE_CASE
+		case FVariantTag:
+			SerializeValue(SerializeArm<FVariant>(Variant, Ar), Ar, context);
+			break;
+		case static_cast<uint8>(EValueType::None):
+			SerializeArm<FEmptyVariantState>(Variant, Ar);
+			break;
+		default:
+			// Written by a newer version of the plugin, there's no way to know how much to skip
+			Ar.SetError();
+			context.bSuccess = false;
+			break;
+		}
+		return context.bSuccess && !Ar.IsError();
+	}
+
+	// -0 and 0 compare equal, so they have to hash the same
+	uint32 HashFloat(const double Value)
+	{
+		return GetTypeHash(Value == 0 ? 0.0 : Value);
+	}
+
+	uint32 HashFloats(const double X, const double Y, const double Z, const double W = 0)
+	{
+		return HashCombineFast(HashCombineFast(HashFloat(X), HashFloat(Y)), HashCombineFast(HashFloat(Z), HashFloat(W)));
+	}
+
+	template <typename Type>
+	uint32 HashValue(const Type& Value)
+	{
+		return GetTypeHash(Value);
+	}
+
+	uint32 HashValue(const FEmptyVariantState&)
+	{
+		return 0;
+	}
+
+	uint32 HashValue(const float Value)
+	{
+		return HashFloat(Value);
+	}
+
+	uint32 HashValue(const double Value)
+	{
+		return HashFloat(Value);
+	}
+
+	// Equality is case sensitive, unlike FString's own GetTypeHash
+	uint32 HashValue(const FString& Value)
+	{
+		return FCrc::StrCrc32(*Value);
+	}
+
+	// Texts are equal when their display strings are, see AreValuesEqual
+	uint32 HashValue(const FText& Value)
+	{
+		return GetTypeHash(Value.ToString());
+	}
+
+	uint32 HashValue(const FVector& Value)
+	{
+		return HashFloats(Value.X, Value.Y, Value.Z);
+	}
+
+	uint32 HashValue(const FRotator& Value)
+	{
+		return HashFloats(Value.Pitch, Value.Yaw, Value.Roll);
+	}
+
+	uint32 HashValue(const FTransform& Value)
+	{
+		const FQuat rotation = Value.GetRotation();
+		return HashCombineFast(HashFloats(rotation.X, rotation.Y, rotation.Z, rotation.W),
+		                       HashCombineFast(HashValue(Value.GetTranslation()), HashValue(Value.GetScale3D())));
+	}
+
+	// Structs without a hash of their own only hash their type, which still agrees with Identical
+	uint32 HashValue(const FInstancedStruct& Value)
+	{
+		const UScriptStruct* scriptStruct = Value.GetScriptStruct();
+		uint32 hash = GetTypeHash(scriptStruct);
+		if (scriptStruct != nullptr && scriptStruct->GetCppStructOps() != nullptr &&
+			scriptStruct->GetCppStructOps()->HasGetTypeHash())
+		{
+			hash = HashCombineFast(hash, scriptStruct->GetStructTypeHash(Value.GetMemory()));
+		}
+		return hash;
+	}
+
+	// FVariant compares its type and bytes
+	uint32 HashValue(const FVariant& Value)
+	{
+		return HashCombineFast(GetTypeHash(Value.GetType()), FCrc::MemCrc32(Value.GetBytes().GetData(),
+		                                                                    Value.GetBytes().Num()));
+	}
+}
+
+uint32 GetTypeHash(const FBpVariant& Variant)
+{
+	return HashCombineFast(GetTypeHash(Variant.Data.GetIndex()), ::Visit([](const auto& Value)
+	{
+		return HashValue(Value);
+	}, Variant.Data));
+}
+
+bool FBpVariant::Serialize(FArchive& Ar)
+{
+	Ar.UsingCustomVersion(FBpVariantCustomVersion::GUID);
+	// Memory archives carry no versions at all, only packages can be older than the compact encoding
+	if (Ar.IsLoading() && Ar.IsPersistent() && Ar.CustomVer(FBpVariantCustomVersion::GUID) <
+		FBpVariantCustomVersion::CompactEncoding)
+	{
+		return false;
+	}
+	SerializeVariant(*this, Ar, nullptr, false);
+	return true;
+}
+
+bool FBpVariant::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = SerializeVariant(*this, Ar, Map, true);
+	return true;
+}
+
+void FBpVariant::AddStructReferencedObjects(FReferenceCollector& Collector)
+{
+	// Only these arms can reference objects. Soft pointers are weak on purpose.
+	// The arm itself is checked, so the GC never depends on anything but Data.
+	if (UObject** object = Data.TryGet<UObject*>())
+	{
+		Collector.AddReferencedObject(*object);
+	}
+	else if (UClass** objectClass = Data.TryGet<UClass*>())
+	{
+		Collector.AddReferencedObject(*objectClass);
+	}
+	else if (FInstancedStruct* value = Data.TryGet<FInstancedStruct>())
+	{
+		value->AddStructReferencedObjects(Collector);
+	}
+}
+
+uint32 UBpVariantStaticsBase::GetNumTypeMismatches()
+{
+	return NumTypeMismatches.load(std::memory_order_relaxed);
+}
+
+void UBpVariantStaticsBase::ReportTypeMismatch(const FBpVariant& Variant, const EValueType Expected)
+{
+	NumTypeMismatches.fetch_add(1, std::memory_order_relaxed);
+	INC_DWORD_STAT(STAT_BpVariantTypeMismatches);
+	// Verbose, since a graph reading the wrong type every tick would flood the log. The stat counts every one.
+	UE_LOG(LogBpValueBox, Verbose, TEXT("Read a variant holding %s as %s"),
+	       *UEnum::GetValueAsString(Variant.GetType()), *UEnum::GetValueAsString(Expected));
+}
@@ -0,0 +1,500 @@
+#include "BpVariantArray.h"
+
+int32 FBpVariantArray::Add(const FBpVariant& Value)
+{
+	const int32 index = Tags.Add(Value.GetType());
+	const int32 slot = GetColumnNum(GetColumn(Value.GetType()));
+	Slots.Add(slot);
+	InsertIntoColumn(Value, slot);
+	return index;
+}
+
+FBpVariant FBpVariantArray::Get(const int32 Index) const
+{
+	const int32 slot = Slots[Index];
+	switch (Tags[Index])
+	{
+	case EValueType::Bool:
+		return UBpVariantStaticsBase::MakeFromGeneric(Bools[slot]);
+	case EValueType::Byte:
+		return UBpVariantStaticsBase::MakeFromGeneric(Bytes[slot]);
+	case EValueType::Int32:
+		return UBpVariantStaticsBase::MakeFromGeneric(Int32s[slot]);
+	case EValueType::Int64:
+		return UBpVariantStaticsBase::MakeFromGeneric(Int64s[slot]);
+	case EValueType::Float32:
+		return UBpVariantStaticsBase::MakeFromGeneric(Float32s[slot]);
+	case EValueType::Float64:
+		return UBpVariantStaticsBase::MakeFromGeneric(Float64s[slot]);
+	case EValueType::Name:
+		return UBpVariantStaticsBase::MakeFromGeneric(Names[slot]);
+	case EValueType::String:
+		return UBpVariantStaticsBase::MakeFromGeneric(FString(GetStringView(Index)));
+	case EValueType::Vector:
+		return UBpVariantStaticsBase::MakeFromGeneric(Vectors[slot]);
+	case EValueType::Rotator:
+		return UBpVariantStaticsBase::MakeFromGeneric(Rotators[slot]);
+	default:
+		return Others[slot];
+	}
+}
+
+void FBpVariantArray::Set(const int32 Index, const FBpVariant& Value)
+{
+	const EColumn column = GetColumn(Value.GetType());
+	if (GetColumn(Tags[Index]) == column)
+	{
+		Tags[Index] = Value.GetType();
+		AssignInColumn(Value, Slots[Index]);
+		CompactArenaIfNeeded();
+		return;
+	}
+
+	// The element moves to another column, keeping both columns in element order
+	RemoveFromColumn(Tags[Index], Slots[Index]);
+	ShiftSlotsAfter(GetColumn(Tags[Index]), Index, -1);
+
+	const int32 slot = CountInColumnBefore(column, Index);
+	Tags[Index] = Value.GetType();
+	Slots[Index] = slot;
+	InsertIntoColumn(Value, slot);
+	ShiftSlotsAfter(column, Index, 1);
+	CompactArenaIfNeeded();
+}
+
+void FBpVariantArray::RemoveAt(const int32 Index)
+{
+	RemoveFromColumn(Tags[Index], Slots[Index]);
+	ShiftSlotsAfter(GetColumn(Tags[Index]), Index, -1);
+	Tags.RemoveAt(Index);
+	Slots.RemoveAt(Index);
+	CompactArenaIfNeeded();
+}
+
+void FBpVariantArray::Reset()
+{
+	Tags.Reset();
+	Slots.Reset();
+	Bools.Reset();
+	Bytes.Reset();
+	Int32s.Reset();
+	Int64s.Reset();
+	Float32s.Reset();
+	Float64s.Reset();
+	Names.Reset();
+	Vectors.Reset();
+	Rotators.Reset();
+	Strings.Reset();
+	StringArena.Reset();
+	NumUnusedChars = 0;
+	Others.Reset();
+}
+
+void FBpVariantArray::Reserve(const int32 Number)
+{
+	// Only the tags know how many elements there will be, the columns grow as values arrive
+	Tags.Reserve(Number);
+	Slots.Reserve(Number);
+}
+
+void FBpVariantArray::FindIndicesOfType(const EValueType Type, TArray<int32>& OutIndices) const
+{
+	const EValueType* tags = Tags.GetData();
+	const int32 num = Tags.Num();
+	for (int32 i = 0; i < num; ++i)
+	{
+		if (tags[i] == Type)
+		{
+			OutIndices.Add(i);
+		}
+	}
+}
+
+int32 FBpVariantArray::CountOfType(const EValueType Type) const
+{
+	const EValueType* tags = Tags.GetData();
+	const int32 num = Tags.Num();
+	int32 count = 0;
+	for (int32 i = 0; i < num; ++i)
+	{
+		count += tags[i] == Type ? 1 : 0;
+	}
+	return count;
+}
+
+FStringView FBpVariantArray::GetStringView(const int32 Index) const
+{
+	if (Tags[Index] != EValueType::String)
+	{
+		return FStringView();
+	}
+	const FBpVariantStringSpan& span = Strings[Slots[Index]];
+	return FStringView(StringArena.GetData() + span.Offset, span.Length);
+}
+
+bool FBpVariantArray::Serialize(FArchive& Ar)
+{
+	// The slots can be worked out from the tags, so only the tags and columns are saved
+	Ar << reinterpret_cast<TArray<uint8>&>(Tags);
+	Ar << Bools;
+	Ar << Bytes;
+	Ar << Int32s;
+	Ar << Int64s;
+	Ar << Float32s;
+	Ar << Float64s;
+	Ar << Names;
+	Ar << Vectors;
+	Ar << Rotators;
+
+	// Strings are saved on their own, dropping any unused characters left in the arena
+	// Every string and other variant belongs to an element, so larger counts can only come from bad data
+	int32 numStrings = Strings.Num();
+	Ar << numStrings;
+	if (Ar.IsLoading() && (numStrings < 0 || numStrings > Tags.Num()))
+	{
+		Ar.SetError();
+		Reset();
+		return true;
+	}
+	if (Ar.IsLoading())
+	{
+		Strings.Reset(numStrings);
+		StringArena.Reset();
+		NumUnusedChars = 0;
+		for (int32 i = 0; i < numStrings && !Ar.IsError(); ++i)
+		{
+			FString value;
+			Ar << value;
+			Strings.Add({AppendToArena(value), value.Len()});
+		}
+	}
+	else
+	{
+		for (const FBpVariantStringSpan& span : Strings)
+		{
+			FString value(FStringView(StringArena.GetData() + span.Offset, span.Length));
+			Ar << value;
+		}
+	}
+
+	int32 numOthers = Others.Num();
+	Ar << numOthers;
+	if (Ar.IsLoading() && (numOthers < 0 || numOthers > Tags.Num()))
+	{
+		Ar.SetError();
+		Reset();
+		return true;
+	}
+	if (Ar.IsLoading())
+	{
+		Others.SetNum(numOthers);
+	}
+	for (FBpVariant& other : Others)
+	{
+		other.Serialize(Ar);
+	}
+
+	if (Ar.IsLoading() && !RebuildSlots())
+	{
+		// The tags don't agree with the columns, so the data can't be trusted
+		Ar.SetError();
+		Reset();
+	}
+	return true;
+}
+
+void FBpVariantArray::AddStructReferencedObjects(FReferenceCollector& Collector)
+{
+	// Object references can only be in the variants that didn't get a column
+	for (FBpVariant& other : Others)
+	{
+		other.AddStructReferencedObjects(Collector);
+	}
+}
+
+bool FBpVariantArray::Identical(const FBpVariantArray* Other, uint32 PortFlags) const
+{
+	// Equal tags mean every column lines up element for element, so the slots don't need comparing
+	if (!Other || Tags != Other->Tags || Bools != Other->Bools || Bytes != Other->Bytes || Int32s != Other->Int32s ||
+		Int64s != Other->Int64s || Float32s != Other->Float32s || Float64s != Other->Float64s ||
+		Names != Other->Names || Vectors != Other->Vectors || Rotators != Other->Rotators || Others != Other->Others)
+	{
+		return false;
+	}
+	for (int32 i = 0; i < Strings.Num(); ++i)
+	{
+		const FBpVariantStringSpan& span = Strings[i];
+		const FBpVariantStringSpan& otherSpan = Other->Strings[i];
+		if (!FStringView(StringArena.GetData() + span.Offset, span.Length).Equals(
+			FStringView(Other->StringArena.GetData() + otherSpan.Offset, otherSpan.Length), ESearchCase::CaseSensitive))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+FBpVariantArray::EColumn FBpVariantArray::GetColumn(const EValueType Type)
+{
+	switch (Type)
+	{
+	case EValueType::Bool:
+		return EColumn::Bools;
+	case EValueType::Byte:
+		return EColumn::Bytes;
+	case EValueType::Int32:
+		return EColumn::Int32s;
+	case EValueType::Int64:
+		return EColumn::Int64s;
+	case EValueType::Float32:
+		return EColumn::Float32s;
+	case EValueType::Float64:
+		return EColumn::Float64s;
+	case EValueType::Name:
+		return EColumn::Names;
+	case EValueType::String:
+		return EColumn::Strings;
+	case EValueType::Vector:
+		return EColumn::Vectors;
+	case EValueType::Rotator:
+		return EColumn::Rotators;
+	default:
+		return EColumn::Others;
+	}
+}
+
+int32 FBpVariantArray::GetColumnNum(const EColumn Column) const
+{
+	switch (Column)
+	{
+	case EColumn::Bools:
+		return Bools.Num();
+	case EColumn::Bytes:
+		return Bytes.Num();
+	case EColumn::Int32s:
+		return Int32s.Num();
+	case EColumn::Int64s:
+		return Int64s.Num();
+	case EColumn::Float32s:
+		return Float32s.Num();
+	case EColumn::Float64s:
+		return Float64s.Num();
+	case EColumn::Names:
+		return Names.Num();
+	case EColumn::Strings:
+		return Strings.Num();
+	case EColumn::Vectors:
+		return Vectors.Num();
+	case EColumn::Rotators:
+		return Rotators.Num();
+	default:
+		return Others.Num();
+	}
+}
+
+void FBpVariantArray::InsertIntoColumn(const FBpVariant& Value, const int32 Slot)
+{
+	switch (Value.GetType())
+	{
+	case EValueType::Bool:
+		Bools.Insert(Value.Data.Get<bool>(), Slot);
+		break;
+	case EValueType::Byte:
+		Bytes.Insert(Value.Data.Get<uint8>(), Slot);
+		break;
+	case EValueType::Int32:
+		Int32s.Insert(Value.Data.Get<int32>(), Slot);
+		break;
+	case EValueType::Int64:
+		Int64s.Insert(Value.Data.Get<int64>(), Slot);
+		break;
+	case EValueType::Float32:
+		Float32s.Insert(Value.Data.Get<float>(), Slot);
+		break;
+	case EValueType::Float64:
+		Float64s.Insert(Value.Data.Get<double>(), Slot);
+		break;
+	case EValueType::Name:
+		Names.Insert(Value.Data.Get<FName>(), Slot);
+		break;
+	case EValueType::String:
+		{
+			const FString& value = Value.Data.Get<FString>();
+			Strings.Insert({AppendToArena(value), value.Len()}, Slot);
+			break;
+		}
+	case EValueType::Vector:
+		Vectors.Insert(Value.Data.Get<FVector>(), Slot);
+		break;
+	case EValueType::Rotator:
+		Rotators.Insert(Value.Data.Get<FRotator>(), Slot);
+		break;
+	default:
+		Others.Insert(Value, Slot);
+		break;
+	}
+}
+
+void FBpVariantArray::RemoveFromColumn(const EValueType Type, const int32 Slot)
+{
+	switch (GetColumn(Type))
+	{
+	case EColumn::Bools:
+		Bools.RemoveAt(Slot);
+		break;
+	case EColumn::Bytes:
+		Bytes.RemoveAt(Slot);
+		break;
+	case EColumn::Int32s:
+		Int32s.RemoveAt(Slot);
+		break;
+	case EColumn::Int64s:
+		Int64s.RemoveAt(Slot);
+		break;
+	case EColumn::Float32s:
+		Float32s.RemoveAt(Slot);
+		break;
+	case EColumn::Float64s:
+		Float64s.RemoveAt(Slot);
+		break;
+	case EColumn::Names:
+		Names.RemoveAt(Slot);
+		break;
+	case EColumn::Strings:
+		NumUnusedChars += Strings[Slot].Length;
+		Strings.RemoveAt(Slot);
+		break;
+	case EColumn::Vectors:
+		Vectors.RemoveAt(Slot);
+		break;
+	case EColumn::Rotators:
+		Rotators.RemoveAt(Slot);
+		break;
+	default:
+		Others.RemoveAt(Slot);
+		break;
+	}
+}
+
+void FBpVariantArray::AssignInColumn(const FBpVariant& Value, const int32 Slot)
+{
+	switch (Value.GetType())
+	{
+	case EValueType::Bool:
+		Bools[Slot] = Value.Data.Get<bool>();
+		break;
+	case EValueType::Byte:
+		Bytes[Slot] = Value.Data.Get<uint8>();
+		break;
+	case EValueType::Int32:
+		Int32s[Slot] = Value.Data.Get<int32>();
+		break;
+	case EValueType::Int64:
+		Int64s[Slot] = Value.Data.Get<int64>();
+		break;
+	case EValueType::Float32:
+		Float32s[Slot] = Value.Data.Get<float>();
+		break;
+	case EValueType::Float64:
+		Float64s[Slot] = Value.Data.Get<double>();
+		break;
+	case EValueType::Name:
+		Names[Slot] = Value.Data.Get<FName>();
+		break;
+	case EValueType::String:
+		{
+			// Reuses the old characters when the new string fits in them
+			const FString& value = Value.Data.Get<FString>();
+			FBpVariantStringSpan& span = Strings[Slot];
+			if (value.Len() <= span.Length)
+			{
+				FMemory::Memcpy(StringArena.GetData() + span.Offset, *value, value.Len() * sizeof(TCHAR));
+				NumUnusedChars += span.Length - value.Len();
+				span.Length = value.Len();
+			}
+			else
+			{
+				NumUnusedChars += span.Length;
+				span = {AppendToArena(value), value.Len()};
+			}
+			break;
+		}
+	case EValueType::Vector:
+		Vectors[Slot] = Value.Data.Get<FVector>();
+		break;
+	case EValueType::Rotator:
+		Rotators[Slot] = Value.Data.Get<FRotator>();
+		break;
+	default:
+		Others[Slot] = Value;
+		break;
+	}
+}
+
+int32 FBpVariantArray::AppendToArena(const FStringView Value)
+{
+	const int32 offset = StringArena.Num();
+	StringArena.Append(Value.GetData(), Value.Len());
+	return offset;
+}
+
+void FBpVariantArray::CompactArenaIfNeeded()
+{
+	// Waiting until at least half of the arena is unused keeps the cost of copying spread over the changes
+	if (NumUnusedChars < 256 || NumUnusedChars * 2 < StringArena.Num())
+	{
+		return;
+	}
+
+	TArray<TCHAR> arena;
+	arena.Reserve(StringArena.Num() - NumUnusedChars);
+	for (FBpVariantStringSpan& span : Strings)
+	{
+		const int32 offset = arena.Num();
+		arena.Append(StringArena.GetData() + span.Offset, span.Length);
+		span.Offset = offset;
+	}
+	StringArena = MoveTemp(arena);
+	NumUnusedChars = 0;
+}
+
+int32 FBpVariantArray::CountInColumnBefore(const EColumn Column, const int32 Index) const
+{
+	int32 count = 0;
+	for (int32 i = 0; i < Index; ++i)
+	{
+		count += GetColumn(Tags[i]) == Column ? 1 : 0;
+	}
+	return count;
+}
+
+void FBpVariantArray::ShiftSlotsAfter(const EColumn Column, const int32 Index, const int32 Delta)
+{
+	for (int32 i = Index + 1; i < Tags.Num(); ++i)
+	{
+		if (GetColumn(Tags[i]) == Column)
+		{
+			Slots[i] += Delta;
+		}
+	}
+}
+
+bool FBpVariantArray::RebuildSlots()
+{
+	constexpr int32 numColumns = static_cast<int32>(EColumn::Others) + 1;
+	int32 counts[numColumns] = {};
+	Slots.SetNumUninitialized(Tags.Num());
+	for (int32 i = 0; i < Tags.Num(); ++i)
+	{
+		Slots[i] = counts[static_cast<int32>(GetColumn(Tags[i]))]++;
+	}
+
+	for (int32 column = 0; column < numColumns; ++column)
+	{
+		if (counts[column] != GetColumnNum(static_cast<EColumn>(column)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,333 @@
+#include "BpVariantBlackboard.h"
+
+#include "BpValueBox.h"
+#include "BpValueBoxSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+namespace
+{
+	// Slots that are claimed but whose name isn't written yet. No FName packs to this.
+	constexpr uint64 ClaimingKey = MAX_uint64;
+
+	// These arms can reference objects, which are only safe to hand to the blackboard where the GC runs
+	bool IsGameThreadOnly(const FBpVariant& Value)
+	{
+		const EValueType type = Value.GetType();
+		return type == EValueType::Object || type == EValueType::Class || type == EValueType::Struct;
+	}
+}
+
+FBpVariantBlackboard::FReadScope::FReadScope(const FBpVariantBlackboard& InBlackboard)
+	: Blackboard(InBlackboard)
+{
+	// The epoch is checked again after counting in, so a flip in between can't miss this reader
+	for (;;)
+	{
+		Epoch = Blackboard.Epoch.load();
+		Blackboard.NumReaders[Epoch].fetch_add(1);
+		if (Blackboard.Epoch.load() == Epoch)
+		{
+			break;
+		}
+		Blackboard.NumReaders[Epoch].fetch_sub(1);
+	}
+}
+
+FBpVariantBlackboard::FReadScope::~FReadScope()
+{
+	Blackboard.NumReaders[Epoch].fetch_sub(1);
+}
+
+FBpVariantBlackboard::FBpVariantBlackboard(const int32 InMaxKeys)
+	: MaxKeys(FMath::Max(InMaxKeys, 1))
+{
+	// At most half full, so probing for a key stays short
+	NumSlots = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(MaxKeys) * 2);
+	Slots = MakeUnique<FSlot[]>(NumSlots);
+}
+
+FBpVariantBlackboard::~FBpVariantBlackboard()
+{
+	for (uint32 i = 0; i < NumSlots; ++i)
+	{
+		delete Slots[i].Value.load();
+	}
+	FValue* value;
+	while (ReplacedValues.Dequeue(value))
+	{
+		delete value;
+	}
+	for (FValue* retired : RetiredValues)
+	{
+		delete retired;
+	}
+}
+
+uint64 FBpVariantBlackboard::PackKey(const FName Key)
+{
+	return static_cast<uint64>(Key.GetComparisonIndex().ToUnstableInt()) << 32 | static_cast<uint32>(Key.GetNumber());
+}
+
+FBpVariantBlackboard::FSlot* FBpVariantBlackboard::FindSlot(const FName Key) const
+{
+	const uint64 packed = PackKey(Key);
+	const uint32 mask = NumSlots - 1;
+	for (uint32 i = GetTypeHash(Key) & mask, probes = 0; probes < NumSlots; i = (i + 1) & mask, ++probes)
+	{
+		FSlot& slot = Slots[i];
+		uint64 key = slot.Key.load(std::memory_order_acquire);
+		// Another thread is publishing a new key here, which only takes as long as copying its name
+		while (key == ClaimingKey)
+		{
+			FPlatformProcess::Yield();
+			key = slot.Key.load(std::memory_order_acquire);
+		}
+		if (key == packed)
+		{
+			return &slot;
+		}
+		if (key == 0)
+		{
+			return nullptr;
+		}
+	}
+	return nullptr;
+}
+
+FBpVariantBlackboard::FSlot* FBpVariantBlackboard::FindOrAddSlot(const FName Key)
+{
+	const uint64 packed = PackKey(Key);
+	const uint32 mask = NumSlots - 1;
+	for (uint32 i = GetTypeHash(Key) & mask, probes = 0; probes < NumSlots; i = (i + 1) & mask, ++probes)
+	{
+		FSlot& slot = Slots[i];
+		uint64 key = slot.Key.load(std::memory_order_acquire);
+		if (key == 0)
+		{
+			if (NumKeys.fetch_add(1) >= MaxKeys)
+			{
+				NumKeys.fetch_sub(1);
+				return nullptr;
+			}
+			if (slot.Key.compare_exchange_strong(key, ClaimingKey))
+			{
+				slot.Name = Key;
+				slot.Key.store(packed, std::memory_order_release);
+				return &slot;
+			}
+			// Another thread claimed the slot first, possibly for this same key, and key now holds what it wrote
+			NumKeys.fetch_sub(1);
+		}
+		while (key == ClaimingKey)
+		{
+			FPlatformProcess::Yield();
+			key = slot.Key.load(std::memory_order_acquire);
+		}
+		if (key == packed)
+		{
+			return &slot;
+		}
+	}
+	return nullptr;
+}
+
+const FBpVariantBlackboard::FValue* FBpVariantBlackboard::FindValue(const FName Key) const
+{
+	const FSlot* slot = FindSlot(Key);
+	return slot ? slot->Value.load(std::memory_order_acquire) : nullptr;
+}
+
+bool FBpVariantBlackboard::SetValue(const FName Key, FBpVariant Value)
+{
+	if (Key.IsNone())
+	{
+		UE_LOG(LogBpValueBox, Warning, TEXT("Variant blackboard keys can't be None"));
+		return false;
+	}
+	if (IsGameThreadOnly(Value) && !IsInGameThread())
+	{
+		UE_LOG(LogBpValueBox, Warning, TEXT("%s can only be written to the variant blackboard from the game thread"),
+		       *UEnum::GetValueAsString(Value.GetType()));
+		return false;
+	}
+
+	FSlot* slot = FindOrAddSlot(Key);
+	if (slot == nullptr)
+	{
+		UE_LOG(LogBpValueBox, Warning, TEXT("The variant blackboard is full, raise MaxBlackboardKeys to add %s"),
+		       *Key.ToString());
+		return false;
+	}
+
+	FValue* value = new FValue{MoveTemp(Value), LastVersion.fetch_add(1) + 1};
+	if (FValue* replaced = slot->Value.exchange(value, std::memory_order_acq_rel))
+	{
+		ReplacedValues.Enqueue(replaced);
+	}
+	if (!slot->bChanged.exchange(true))
+	{
+		ChangedSlots.Enqueue(slot);
+	}
+	return true;
+}
+
+bool FBpVariantBlackboard::TryGetValue(const FName Key, FBpVariant& OutValue, uint64* OutVersion) const
+{
+	const FReadScope scope(*this);
+	const FValue* value = FindValue(Key);
+	if (value == nullptr)
+	{
+		return false;
+	}
+	OutValue = value->Variant;
+	if (OutVersion != nullptr)
+	{
+		*OutVersion = value->Version;
+	}
+	return true;
+}
+
+uint64 FBpVariantBlackboard::GetVersion(const FName Key) const
+{
+	const FReadScope scope(*this);
+	const FValue* value = FindValue(Key);
+	return value ? value->Version : 0;
+}
+
+TArray<FName> FBpVariantBlackboard::GetKeys() const
+{
+	TArray<FName> keys;
+	for (uint32 i = 0; i < NumSlots; ++i)
+	{
+		const uint64 key = Slots[i].Key.load(std::memory_order_acquire);
+		if (key != 0 && key != ClaimingKey)
+		{
+			keys.Add(Slots[i].Name);
+		}
+	}
+	return keys;
+}
+
+void FBpVariantBlackboard::ReclaimValues()
+{
+	// Values retired by the last flush were replaced before it flipped the epoch, so only readers that counted into the
+	// previous epoch can still have them
+	if (!RetiredValues.IsEmpty())
+	{
+		if (NumReaders[1 - Epoch.load()].load() != 0)
+		{
+			return;
+		}
+		for (FValue* value : RetiredValues)
+		{
+			delete value;
+		}
+		RetiredValues.Reset();
+	}
+
+	FValue* value;
+	while (ReplacedValues.Dequeue(value))
+	{
+		RetiredValues.Add(value);
+	}
+	if (!RetiredValues.IsEmpty())
+	{
+		Epoch.store(1 - Epoch.load());
+	}
+}
+
+void FBpVariantBlackboard::Flush(TArray<FName>& OutChangedKeys)
+{
+	check(IsInGameThread());
+	ReclaimValues();
+
+	// Clearing the flag before reading the name means a write after this point queues the slot again
+	OutChangedKeys.Reset();
+	FSlot* slot;
+	while (ChangedSlots.Dequeue(slot))
+	{
+		slot->bChanged.store(false);
+		OutChangedKeys.Add(slot->Name);
+	}
+}
+
+void FBpVariantBlackboard::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	// Only the game thread writes object arms, so the snapshots holding them can't be replaced during the GC
+	const FReadScope scope(*this);
+	for (uint32 i = 0; i < NumSlots; ++i)
+	{
+		if (FValue* value = Slots[i].Value.load(std::memory_order_acquire))
+		{
+			if (IsGameThreadOnly(value->Variant))
+			{
+				value->Variant.AddStructReferencedObjects(Collector);
+			}
+		}
+	}
+}
+
+UBpVariantBlackboardSubsystem* UBpVariantBlackboardSubsystem::Get(const UObject* Context)
+{
+	if (!GEngine || !Context)
+	{
+		return nullptr;
+	}
+	const UWorld* world = GEngine->GetWorldFromContextObject(Context, EGetWorldErrorMode::ReturnNull);
+	return world ? world->GetSubsystem<UBpVariantBlackboardSubsystem>() : nullptr;
+}
+
+void UBpVariantBlackboardSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	Blackboard = MakeShared<FBpVariantBlackboard, ESPMode::ThreadSafe>(
+		GetDefault<UBpValueBoxSettings>()->MaxBlackboardKeys);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(
+		this, &UBpVariantBlackboardSubsystem::HandleWorldPostActorTick);
+}
+
+void UBpVariantBlackboardSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	Super::Deinitialize();
+}
+
+void UBpVariantBlackboardSubsystem::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	Super::AddReferencedObjects(InThis, Collector);
+	const UBpVariantBlackboardSubsystem* subsystem = CastChecked<UBpVariantBlackboardSubsystem>(InThis);
+	if (subsystem->Blackboard.IsValid())
+	{
+		subsystem->Blackboard->AddReferencedObjects(Collector);
+	}
+}
+
+bool UBpVariantBlackboardSubsystem::SetBlackboardValue(const FName Key, const FBpVariant& Value)
+{
+	return Blackboard->SetValue(Key, Value);
+}
+
+bool UBpVariantBlackboardSubsystem::GetBlackboardValue(const FName Key, FBpVariant& Value) const
+{
+	return Blackboard->TryGetValue(Key, Value);
+}
+
+void UBpVariantBlackboardSubsystem::FlushChanges()
+{
+	TArray<FName> changedKeys;
+	Blackboard->Flush(changedKeys);
+	if (!changedKeys.IsEmpty())
+	{
+		OnKeysChanged.Broadcast(changedKeys);
+		OnBlackboardKeysChanged.Broadcast(changedKeys);
+	}
+}
+
+void UBpVariantBlackboardSubsystem::HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World == GetWorld())
+	{
+		FlushChanges();
+	}
+}
@@ -0,0 +1,378 @@
+#include "BpVariant.h"
+
+namespace
+{
+	constexpr int32 NumConvertibleTypes = TTupleArity<FBpVariantValueTypes>::Value;
+
+	template <int32 Index>
+	using TConvertibleType = typename TTupleElement<Index, FBpVariantValueTypes>::Type;
+
+	template <typename Type>
+	constexpr bool IsNumeric = std::is_arithmetic_v<Type>;
+
+	template <typename Type>
+	constexpr bool IsText = std::is_same_v<Type, FName> || std::is_same_v<Type, FString> || std::is_same_v<Type, FText>;
+
+	template <typename Type>
+	constexpr bool IsMath = std::is_same_v<Type, FVector> || std::is_same_v<Type, FRotator> ||
+		std::is_same_v<Type, FTransform>;
+
+	template <typename Type>
+	constexpr bool IsSoft = std::is_same_v<Type, TSoftObjectPtr<UObject>> ||
+		std::is_same_v<Type, TSoftClassPtr<UObject>>;
+
+	template <typename Type>
+	constexpr bool IsClass = std::is_same_v<Type, UClass*> || std::is_same_v<Type, TSoftClassPtr<UObject>>;
+
+	template <typename Type>
+	constexpr bool IsObject = std::is_same_v<Type, UObject*> || std::is_same_v<Type, UClass*> || IsSoft<Type>;
+
+	// Lossless when every value of TFrom fits in TTo exactly
+	template <typename TFrom, typename TTo>
+	constexpr bool IsExactNumeric()
+	{
+		return std::numeric_limits<TFrom>::digits <= std::numeric_limits<TTo>::digits &&
+			(!std::is_signed_v<TFrom> || std::is_signed_v<TTo>) &&
+			(!std::is_floating_point_v<TFrom> || std::is_floating_point_v<TTo>);
+	}
+
+	// Must have a branch for every conversion ConvertValue does, and reject everything else
+	template <typename TFrom, typename TTo>
+	constexpr EBpVariantConversion GetConversionKind()
+	{
+		constexpr EBpVariantConversion lossless = EBpVariantConversion::Lossless;
+		constexpr EBpVariantConversion lossy = EBpVariantConversion::Lossy;
+
+		if constexpr (std::is_same_v<TFrom, TTo>)
+		{
+			return lossless;
+		}
+		else if constexpr (IsNumeric<TFrom> && IsNumeric<TTo>)
+		{
+			return IsExactNumeric<TFrom, TTo>() ? lossless : lossy;
+		}
+		else if constexpr (IsNumeric<TFrom> && IsText<TTo>)
+		{
+			// Floats are printed with a readable number of digits
+			return std::is_integral_v<TFrom> ? lossless : lossy;
+		}
+		else if constexpr (IsText<TFrom> && (IsNumeric<TTo> || IsMath<TTo>))
+		{
+			return lossy;
+		}
+		else if constexpr (IsText<TFrom> && IsText<TTo>)
+		{
+			// Names ignore case and texts lose their localization
+			return !std::is_same_v<TFrom, FText> && !std::is_same_v<TTo, FName> ? lossless : lossy;
+		}
+		else if constexpr (IsMath<TFrom> && (IsText<TTo> || IsMath<TTo>))
+		{
+			return std::is_same_v<TFrom, FVector> && std::is_same_v<TTo, FTransform> ? lossless : lossy;
+		}
+		else if constexpr (IsObject<TFrom> && IsObject<TTo>)
+		{
+			// Soft pointers to hard ones only work when the object is loaded, and objects to classes when it's a class
+			return (IsClass<TFrom> || !IsClass<TTo>) && (!IsSoft<TFrom> || IsSoft<TTo>) ? lossless : lossy;
+		}
+		else if constexpr (IsObject<TFrom> && std::is_same_v<TTo, FString>)
+		{
+			return IsSoft<TFrom> ? lossless : lossy;
+		}
+		else if constexpr (std::is_same_v<TFrom, FString> && IsSoft<TTo>)
+		{
+			return lossy;
+		}
+		else
+		{
+			return EBpVariantConversion::Rejected;
+		}
+	}
+
+	// Saturates instead of wrapping, and maps NaN to zero
+	template <typename TTo, typename TFrom>
+	TTo NumericCast(const TFrom From)
+	{
+		if constexpr (std::is_same_v<TTo, bool>)
+		{
+			return From != 0;
+		}
+		else if constexpr (std::is_floating_point_v<TTo>)
+		{
+			return static_cast<TTo>(From);
+		}
+		else if constexpr (std::is_floating_point_v<TFrom>)
+		{
+			if (FMath::IsNaN(From))
+			{
+				return 0;
+			}
+			if (From <= static_cast<TFrom>(TNumericLimits<TTo>::Min()))
+			{
+				return TNumericLimits<TTo>::Min();
+			}
+			if (From >= static_cast<TFrom>(TNumericLimits<TTo>::Max()))
+			{
+				return TNumericLimits<TTo>::Max();
+			}
+			return static_cast<TTo>(From);
+		}
+		else
+		{
+			return static_cast<TTo>(FMath::Clamp<int64>(From, TNumericLimits<TTo>::Min(), TNumericLimits<TTo>::Max()));
+		}
+	}
+
+	FString ToString(const FName& Value) { return Value.ToString(); }
+	const FString& ToString(const FString& Value) { return Value; }
+	const FString& ToString(const FText& Value) { return Value.ToString(); }
+
+	template <typename TTo>
+	TTo FromString(const FString& Value)
+	{
+		if constexpr (std::is_same_v<TTo, FName>)
+		{
+			return FName(*Value);
+		}
+		else if constexpr (std::is_same_v<TTo, FText>)
+		{
+			return FText::FromString(Value);
+		}
+		else
+		{
+			return Value;
+		}
+	}
+
+	void ConvertMath(const FVector& From, FRotator& To) { To = From.Rotation(); }
+	void ConvertMath(const FVector& From, FTransform& To) { To = FTransform(From); }
+	void ConvertMath(const FRotator& From, FVector& To) { To = From.Vector(); }
+	void ConvertMath(const FRotator& From, FTransform& To) { To = FTransform(From); }
+	void ConvertMath(const FTransform& From, FVector& To) { To = From.GetTranslation(); }
+	void ConvertMath(const FTransform& From, FRotator& To) { To = From.Rotator(); }
+
+	FSoftObjectPath GetPath(const UObject* Value) { return FSoftObjectPath(Value); }
+	FSoftObjectPath GetPath(const TSoftObjectPtr<UObject>& Value) { return Value.ToSoftObjectPath(); }
+	FSoftObjectPath GetPath(const TSoftClassPtr<UObject>& Value) { return Value.ToSoftObjectPath(); }
+
+	// Soft pointers are never loaded here, so they only convert to hard ones when they're already in memory
+	template <typename TFrom, typename TTo>
+	bool ConvertObject(const TFrom& From, TTo& To)
+	{
+		if constexpr (IsSoft<TTo>)
+		{
+			To = TTo(GetPath(From));
+			return true;
+		}
+		else
+		{
+			UObject* object;
+			bool bNull;
+			if constexpr (IsSoft<TFrom>)
+			{
+				object = From.Get();
+				bNull = From.IsNull();
+			}
+			else
+			{
+				object = From;
+				bNull = From == nullptr;
+			}
+			To = Cast<std::remove_pointer_t<TTo>>(object);
+			return bNull || To != nullptr;
+		}
+	}
+
+	template <typename TFrom, typename TTo>
+	bool ConvertValue(const TFrom& From, TTo& To)
+	{
+		if constexpr (std::is_same_v<TFrom, TTo>)
+		{
+			To = From;
+			return true;
+		}
+		else if constexpr (IsNumeric<TFrom> && IsNumeric<TTo>)
+		{
+			To = NumericCast<TTo>(From);
+			return true;
+		}
+		else if constexpr (IsNumeric<TFrom> && IsText<TTo>)
+		{
+			if constexpr (std::is_floating_point_v<TFrom>)
+			{
+				To = FromString<TTo>(FString::SanitizeFloat(From));
+			}
+			else
+			{
+				To = FromString<TTo>(LexToString(From));
+			}
+			return true;
+		}
+		else if constexpr (IsText<TFrom> && IsNumeric<TTo>)
+		{
+			return LexTryParseString(To, *ToString(From));
+		}
+		else if constexpr (IsText<TFrom> && IsMath<TTo>)
+		{
+			return To.InitFromString(ToString(From));
+		}
+		else if constexpr (IsText<TFrom> && IsText<TTo>)
+		{
+			To = FromString<TTo>(ToString(From));
+			return true;
+		}
+		else if constexpr (IsMath<TFrom> && IsText<TTo>)
+		{
+			To = FromString<TTo>(From.ToString());
+			return true;
+		}
+		else if constexpr (IsMath<TFrom> && IsMath<TTo>)
+		{
+			ConvertMath(From, To);
+			return true;
+		}
+		else if constexpr (IsObject<TFrom> && IsObject<TTo>)
+		{
+			return ConvertObject(From, To);
+		}
+		else if constexpr (IsObject<TFrom> && std::is_same_v<TTo, FString>)
+		{
+			To = GetPath(From).ToString();
+			return true;
+		}
+		else
+		{
+			static_assert(std::is_same_v<TFrom, FString> && IsSoft<TTo>,
+				"GetConversionKind allows a conversion ConvertValue doesn't do");
+			To = TTo(FSoftObjectPath(From));
+			return From.IsEmpty() || !To.IsNull();
+		}
+	}
+
+	using FConvertFunction = bool(*)(const FBpVariant& Variant, FBpVariant& OutResult);
+
+	struct FConversionEntry
+	{
+		EBpVariantConversion Kind;
+		FConvertFunction Convert;
+	};
+
+	template <typename TFrom, typename TTo>
+	bool ConvertArm(const FBpVariant& Variant, FBpVariant& OutResult)
+	{
+		TTo value = TTo();
+		if (!ConvertValue(Variant.Data.Get<TFrom>(), value))
+		{
+			return false;
+		}
+		UBpVariantStaticsBase::Assign(OutResult, MoveTemp(value));
+		return true;
+	}
+
+	template <int32 FromIndex, int32 ToIndex>
+	constexpr FConversionEntry MakeConversionEntry()
+	{
+		using TFrom = TConvertibleType<FromIndex>;
+		using TTo = TConvertibleType<ToIndex>;
+		constexpr EBpVariantConversion kind = GetConversionKind<TFrom, TTo>();
+		if constexpr (kind == EBpVariantConversion::Rejected)
+		{
+			return {kind, nullptr};
+		}
+		else
+		{
+			return {kind, &ConvertArm<TFrom, TTo>};
+		}
+	}
+
+	// Where each EValueType is in FBpVariantValueTypes, which isn't its value for types added after None
+	struct FTypeIndices
+	{
+		int32 Indices[TNumericLimits<uint8>::Max() + 1];
+
+		int32 Get(const EValueType Type) const
+		{
+			return Indices[static_cast<uint8>(Type)];
+		}
+	};
+
+	template <int32... Indices>
+	constexpr FTypeIndices MakeTypeIndices(TIntegerSequence<int32, Indices...>)
+	{
+		FTypeIndices result{};
+		for (int32& index : result.Indices)
+		{
+			index = INDEX_NONE;
+		}
+		((result.Indices[static_cast<uint8>(TBpVariantTraits<TConvertibleType<Indices>>::ValueType)] = Indices), ...);
+		return result;
+	}
+
+	constexpr FTypeIndices TypeIndices = MakeTypeIndices(TMakeIntegerSequence<int32, NumConvertibleTypes>());
+
+	// Row per source type, column per target type
+	struct FConversionMatrix
+	{
+		FConversionEntry Entries[NumConvertibleTypes * NumConvertibleTypes];
+
+		const FConversionEntry& Get(const EValueType From, const EValueType To) const
+		{
+			return Entries[TypeIndices.Get(From) * NumConvertibleTypes + TypeIndices.Get(To)];
+		}
+	};
+
+	template <int32... Indices>
+	constexpr FConversionMatrix MakeConversionMatrix(TIntegerSequence<int32, Indices...>)
+	{
+		return {{MakeConversionEntry<Indices / NumConvertibleTypes, Indices % NumConvertibleTypes>()...}};
+	}
+
+	constexpr FConversionMatrix ConversionMatrix =
+		MakeConversionMatrix(TMakeIntegerSequence<int32, NumConvertibleTypes * NumConvertibleTypes>());
+
+	bool IsConvertible(const EValueType Type)
+	{
+		return TypeIndices.Get(Type) != INDEX_NONE;
+	}
+}
+
+EBpVariantConversion UBpVariantStaticsBase::GetConversion(const EValueType From, const EValueType To)
+{
+	if (!IsConvertible(From) || !IsConvertible(To))
+	{
+		return From == To ? EBpVariantConversion::Lossless : EBpVariantConversion::Rejected;
+	}
+	return ConversionMatrix.Get(From, To).Kind;
+}
+
+bool UBpVariantStaticsBase::ConvertTo(const FBpVariant& Variant, const EValueType Type, FBpVariant& Result,
+                                      EBpVariantConversion& Conversion, const bool bAllowLossy)
+{
+	Conversion = GetConversion(Variant.GetType(), Type);
+	if (Variant.GetType() == Type)
+	{
+		Result = Variant;
+		return true;
+	}
+
+	// Result may be the variant being converted
+	FBpVariant converted;
+	const bool bConverted = Conversion != EBpVariantConversion::Rejected &&
+		(bAllowLossy || Conversion == EBpVariantConversion::Lossless) &&
+		ConversionMatrix.Get(Variant.GetType(), Type).Convert(Variant, converted);
+	Result = MoveTemp(converted);
+	return bConverted;
+}
+
+int32 UBpVariantStaticsBase::ConvertArray(const TConstArrayView<FBpVariant> Variants, const EValueType Type,
+                                          const TArrayView<FBpVariant> OutResults, const bool bAllowLossy)
+{
+	check(OutResults.Num() == Variants.Num());
+
+	int32 numConverted = 0;
+	EBpVariantConversion conversion;
+	for (int32 i = 0; i < Variants.Num(); ++i)
+	{
+		numConverted += ConvertTo(Variants[i], Type, OutResults[i], conversion, bAllowLossy) ? 1 : 0;
+	}
+	return numConverted;
+}
@@ -0,0 +1,528 @@
+#include "BpVariantKernels.h"
+
+namespace
+{
+	// Variants are read into batches this big before going through the SIMD loops
+	constexpr int32 BatchSize = 256;
+
+	template <typename Type>
+	struct TKernelRegister;
+
+	template <>
+	struct TKernelRegister<double>
+	{
+		using Type = VectorRegister4Double;
+		static Type Zero() { return VectorZeroDouble(); }
+	};
+
+	template <>
+	struct TKernelRegister<float>
+	{
+		using Type = VectorRegister4Float;
+		static Type Zero() { return VectorZeroFloat(); }
+	};
+
+	template <typename Type>
+	double SumKernel(const Type* Values, const int32 Num)
+	{
+		using FRegister = typename TKernelRegister<Type>::Type;
+
+		// Two accumulators so each add doesn't wait on the one before it
+		FRegister sum0 = TKernelRegister<Type>::Zero();
+		FRegister sum1 = TKernelRegister<Type>::Zero();
+		int32 i = 0;
+		for (; i + 8 <= Num; i += 8)
+		{
+			sum0 = VectorAdd(sum0, VectorLoad(Values + i));
+			sum1 = VectorAdd(sum1, VectorLoad(Values + i + 4));
+		}
+		for (; i + 4 <= Num; i += 4)
+		{
+			sum0 = VectorAdd(sum0, VectorLoad(Values + i));
+		}
+
+		Type lanes[4];
+		VectorStore(VectorAdd(sum0, sum1), lanes);
+		double sum = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+		for (; i < Num; ++i)
+		{
+			sum += Values[i];
+		}
+		return sum;
+	}
+
+	template <typename Type>
+	bool MinMaxKernel(const Type* Values, const int32 Num, Type& OutMin, Type& OutMax)
+	{
+		if (Num == 0)
+		{
+			return false;
+		}
+
+		int32 i = 0;
+		Type min = Values[0];
+		Type max = Values[0];
+		if (Num >= 4)
+		{
+			auto minimums = VectorLoad(Values);
+			auto maximums = minimums;
+			for (i = 4; i + 4 <= Num; i += 4)
+			{
+				const auto values = VectorLoad(Values + i);
+				minimums = VectorMin(minimums, values);
+				maximums = VectorMax(maximums, values);
+			}
+
+			Type minLanes[4];
+			Type maxLanes[4];
+			VectorStore(minimums, minLanes);
+			VectorStore(maximums, maxLanes);
+			for (int32 lane = 0; lane < 4; ++lane)
+			{
+				min = FMath::Min(min, minLanes[lane]);
+				max = FMath::Max(max, maxLanes[lane]);
+			}
+		}
+		for (; i < Num; ++i)
+		{
+			min = FMath::Min(min, Values[i]);
+			max = FMath::Max(max, Values[i]);
+		}
+
+		OutMin = min;
+		OutMax = max;
+		return true;
+	}
+
+	template <typename Type>
+	void ScaleKernel(Type* Values, const int32 Num, const Type Factor)
+	{
+		const auto factor = VectorSetFloat1(Factor);
+		int32 i = 0;
+		for (; i + 4 <= Num; i += 4)
+		{
+			VectorStore(VectorMultiply(VectorLoad(Values + i), factor), Values + i);
+		}
+		for (; i < Num; ++i)
+		{
+			Values[i] *= Factor;
+		}
+	}
+
+	void LerpKernel(const double* A, const double* B, const double Alpha, double* OutValues, const int32 Num)
+	{
+		const VectorRegister4Double alpha = VectorSetFloat1(Alpha);
+		int32 i = 0;
+		for (; i + 4 <= Num; i += 4)
+		{
+			const VectorRegister4Double a = VectorLoad(A + i);
+			const VectorRegister4Double b = VectorLoad(B + i);
+			VectorStore(VectorMultiplyAdd(VectorSubtract(b, a), alpha, a), OutValues + i);
+		}
+		for (; i < Num; ++i)
+		{
+			OutValues[i] = FMath::Lerp(A[i], B[i], Alpha);
+		}
+	}
+
+	template <typename TVectorCompare, typename TScalarCompare>
+	void CompareKernel(const double* Values, const int32 Num, const double Scalar, bool* OutResults,
+	                   TVectorCompare VectorCompare, TScalarCompare ScalarCompare)
+	{
+		const VectorRegister4Double scalar = VectorSetFloat1(Scalar);
+		int32 i = 0;
+		for (; i + 4 <= Num; i += 4)
+		{
+			const int32 mask = VectorMaskBits(VectorCompare(VectorLoad(Values + i), scalar));
+			OutResults[i] = (mask & 1) != 0;
+			OutResults[i + 1] = (mask & 2) != 0;
+			OutResults[i + 2] = (mask & 4) != 0;
+			OutResults[i + 3] = (mask & 8) != 0;
+		}
+		for (; i < Num; ++i)
+		{
+			OutResults[i] = ScalarCompare(Values[i], Scalar);
+		}
+	}
+
+	void CompareKernel(const double* Values, const int32 Num, const double Scalar,
+	                   const EBpVariantComparison Comparison, bool* OutResults)
+	{
+		// Picks the comparison once, outside of the loop
+		switch (Comparison)
+		{
+		case EBpVariantComparison::Less:
+			CompareKernel(Values, Num, Scalar, OutResults,
+			              [](const VectorRegister4Double& A, const VectorRegister4Double& B)
+			              {
+				              return VectorCompareLT(A, B);
+			              },
+			              [](const double A, const double B) { return A < B; });
+			break;
+		case EBpVariantComparison::LessOrEqual:
+			CompareKernel(Values, Num, Scalar, OutResults,
+			              [](const VectorRegister4Double& A, const VectorRegister4Double& B)
+			              {
+				              return VectorCompareLE(A, B);
+			              },
+			              [](const double A, const double B) { return A <= B; });
+			break;
+		case EBpVariantComparison::Equal:
+			CompareKernel(Values, Num, Scalar, OutResults,
+			              [](const VectorRegister4Double& A, const VectorRegister4Double& B)
+			              {
+				              return VectorCompareEQ(A, B);
+			              },
+			              [](const double A, const double B) { return A == B; });
+			break;
+		case EBpVariantComparison::NotEqual:
+			CompareKernel(Values, Num, Scalar, OutResults,
+			              [](const VectorRegister4Double& A, const VectorRegister4Double& B)
+			              {
+				              return VectorCompareNE(A, B);
+			              },
+			              [](const double A, const double B) { return A != B; });
+			break;
+		case EBpVariantComparison::Greater:
+			CompareKernel(Values, Num, Scalar, OutResults,
+			              [](const VectorRegister4Double& A, const VectorRegister4Double& B)
+			              {
+				              return VectorCompareGT(A, B);
+			              },
+			              [](const double A, const double B) { return A > B; });
+			break;
+		case EBpVariantComparison::GreaterOrEqual:
+			CompareKernel(Values, Num, Scalar, OutResults,
+			              [](const VectorRegister4Double& A, const VectorRegister4Double& B)
+			              {
+				              return VectorCompareGE(A, B);
+			              },
+			              [](const double A, const double B) { return A >= B; });
+			break;
+		}
+	}
+
+	bool IsNumber(const EValueType Type)
+	{
+		switch (Type)
+		{
+		case EValueType::Byte:
+		case EValueType::Int32:
+		case EValueType::Int64:
+		case EValueType::Float32:
+		case EValueType::Float64:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// Reads variants of one type into the batch until the type changes or the batch is full
+	template <typename Type>
+	void GatherRun(TConstArrayView<FBpVariant> Values, int32& Index, double* Batch, int32& Count)
+	{
+		constexpr EValueType type = TBpVariantValueType<Type>::Value;
+		const FBpVariant* values = Values.GetData();
+		const int32 num = Values.Num();
+		while (Index < num && Count < BatchSize && values[Index].GetType() == type)
+		{
+			Batch[Count++] = static_cast<double>(values[Index++].Data.Get<Type>());
+		}
+	}
+
+	/*
+	Fills the batch from Index onwards. When bSkipOthers is set, variants that aren't numbers are left out.
+	Otherwise they take Fallback so the batch lines up with the variants.
+	*/
+	int32 GatherBatch(TConstArrayView<FBpVariant> Values, int32& Index, double* Batch, const bool bSkipOthers,
+	                  const double Fallback = 0)
+	{
+		int32 count = 0;
+		while (Index < Values.Num() && count < BatchSize)
+		{
+			switch (Values[Index].GetType())
+			{
+			case EValueType::Byte:
+				GatherRun<uint8>(Values, Index, Batch, count);
+				break;
+			case EValueType::Int32:
+				GatherRun<int32>(Values, Index, Batch, count);
+				break;
+			case EValueType::Int64:
+				GatherRun<int64>(Values, Index, Batch, count);
+				break;
+			case EValueType::Float32:
+				GatherRun<float>(Values, Index, Batch, count);
+				break;
+			case EValueType::Float64:
+				GatherRun<double>(Values, Index, Batch, count);
+				break;
+			default:
+				if (!bSkipOthers)
+				{
+					Batch[count++] = Fallback;
+				}
+				++Index;
+				break;
+			}
+		}
+		return count;
+	}
+
+	/*
+	Rounds to the nearest Type, saturating at its limits, with NaN becoming 0. The bound above Max is a power of two, so
+	it is exact as a double even where Max itself isn't, like int64's.
+	*/
+	template <typename Type>
+	Type RoundToInteger(const double Value)
+	{
+		constexpr double upperBound = 2.0 * static_cast<double>(TNumericLimits<Type>::Max() / 2 + 1);
+		constexpr double lowest = static_cast<double>(TNumericLimits<Type>::Lowest());
+		const double rounded = FMath::RoundToDouble(Value);
+		if (FMath::IsNaN(rounded))
+		{
+			return 0;
+		}
+		if (rounded >= upperBound)
+		{
+			return TNumericLimits<Type>::Max();
+		}
+		if (rounded <= lowest)
+		{
+			return TNumericLimits<Type>::Lowest();
+		}
+		return static_cast<Type>(rounded);
+	}
+
+	template <typename Type>
+	void ScaleRun(TArrayView<FBpVariant> Values, int32& Index, const double Factor)
+	{
+		constexpr EValueType type = TBpVariantValueType<Type>::Value;
+		FBpVariant* values = Values.GetData();
+		const int32 num = Values.Num();
+		for (; Index < num && values[Index].GetType() == type; ++Index)
+		{
+			Type& value = values[Index].Data.Get<Type>();
+			if constexpr (std::is_integral_v<Type>)
+			{
+				value = RoundToInteger<Type>(static_cast<double>(value) * Factor);
+			}
+			else
+			{
+				value = static_cast<Type>(value * Factor);
+			}
+		}
+	}
+
+	template <typename Type>
+	double SumIntegers(TConstArrayView<Type> Values)
+	{
+		// Plain loop, the compiler already vectorizes integer adds
+		double sum = 0;
+		for (const Type value : Values)
+		{
+			sum += static_cast<double>(value);
+		}
+		return sum;
+	}
+
+	template <typename Type>
+	void MinMaxIntegers(TConstArrayView<Type> Values, double& OutMin, double& OutMax, bool& bOutFound)
+	{
+		for (const Type value : Values)
+		{
+			OutMin = bOutFound ? FMath::Min(OutMin, static_cast<double>(value)) : static_cast<double>(value);
+			OutMax = bOutFound ? FMath::Max(OutMax, static_cast<double>(value)) : static_cast<double>(value);
+			bOutFound = true;
+		}
+	}
+
+	template <typename Type>
+	void ScaleIntegers(TArrayView<Type> Values, const double Factor)
+	{
+		for (Type& value : Values)
+		{
+			value = RoundToInteger<Type>(static_cast<double>(value) * Factor);
+		}
+	}
+
+	void CombineMinMax(const double Min, const double Max, double& OutMin, double& OutMax, bool& bOutFound)
+	{
+		OutMin = bOutFound ? FMath::Min(OutMin, Min) : Min;
+		OutMax = bOutFound ? FMath::Max(OutMax, Max) : Max;
+		bOutFound = true;
+	}
+}
+
+double FBpVariantKernels::Sum(const TConstArrayView<double> Values)
+{
+	return SumKernel(Values.GetData(), Values.Num());
+}
+
+double FBpVariantKernels::Sum(const TConstArrayView<float> Values)
+{
+	return SumKernel(Values.GetData(), Values.Num());
+}
+
+bool FBpVariantKernels::MinMax(const TConstArrayView<double> Values, double& OutMin, double& OutMax)
+{
+	return MinMaxKernel(Values.GetData(), Values.Num(), OutMin, OutMax);
+}
+
+bool FBpVariantKernels::MinMax(const TConstArrayView<float> Values, float& OutMin, float& OutMax)
+{
+	return MinMaxKernel(Values.GetData(), Values.Num(), OutMin, OutMax);
+}
+
+void FBpVariantKernels::Scale(const TArrayView<double> Values, const double Factor)
+{
+	ScaleKernel(Values.GetData(), Values.Num(), Factor);
+}
+
+void FBpVariantKernels::Scale(const TArrayView<float> Values, const float Factor)
+{
+	ScaleKernel(Values.GetData(), Values.Num(), Factor);
+}
+
+void FBpVariantKernels::Lerp(const TConstArrayView<double> A, const TConstArrayView<double> B, const double Alpha,
+                             const TArrayView<double> OutValues)
+{
+	check(A.Num() == B.Num() && A.Num() == OutValues.Num());
+	LerpKernel(A.GetData(), B.GetData(), Alpha, OutValues.GetData(), OutValues.Num());
+}
+
+void FBpVariantKernels::CompareToScalar(const TConstArrayView<double> Values, const double Scalar,
+                                        const EBpVariantComparison Comparison, TArray<bool>& OutResults)
+{
+	OutResults.SetNumUninitialized(Values.Num());
+	CompareKernel(Values.GetData(), Values.Num(), Scalar, Comparison, OutResults.GetData());
+}
+
+double FBpVariantKernels::Sum(const TConstArrayView<FBpVariant> Values)
+{
+	double batch[BatchSize];
+	double sum = 0;
+	for (int32 index = 0; index < Values.Num();)
+	{
+		const int32 count = GatherBatch(Values, index, batch, true);
+		sum += SumKernel(batch, count);
+	}
+	return sum;
+}
+
+bool FBpVariantKernels::MinMax(const TConstArrayView<FBpVariant> Values, double& OutMin, double& OutMax)
+{
+	double batch[BatchSize];
+	bool bFound = false;
+	for (int32 index = 0; index < Values.Num();)
+	{
+		const int32 count = GatherBatch(Values, index, batch, true);
+		double min;
+		double max;
+		if (MinMaxKernel(batch, count, min, max))
+		{
+			CombineMinMax(min, max, OutMin, OutMax, bFound);
+		}
+	}
+	return bFound;
+}
+
+void FBpVariantKernels::Scale(const TArrayView<FBpVariant> Values, const double Factor)
+{
+	// Writing back means touching every variant anyway, so this goes one run at a time without a batch
+	for (int32 index = 0; index < Values.Num();)
+	{
+		switch (Values[index].GetType())
+		{
+		case EValueType::Byte:
+			ScaleRun<uint8>(Values, index, Factor);
+			break;
+		case EValueType::Int32:
+			ScaleRun<int32>(Values, index, Factor);
+			break;
+		case EValueType::Int64:
+			ScaleRun<int64>(Values, index, Factor);
+			break;
+		case EValueType::Float32:
+			ScaleRun<float>(Values, index, Factor);
+			break;
+		case EValueType::Float64:
+			ScaleRun<double>(Values, index, Factor);
+			break;
+		default:
+			++index;
+			break;
+		}
+	}
+}
+
+void FBpVariantKernels::Lerp(const TConstArrayView<FBpVariant> A, const TConstArrayView<FBpVariant> B,
+                             const double Alpha, TArray<double>& OutValues)
+{
+	const int32 num = FMath::Min(A.Num(), B.Num());
+	OutValues.SetNumUninitialized(num);
+
+	double batchA[BatchSize];
+	double batchB[BatchSize];
+	for (int32 indexA = 0, indexB = 0; indexA < num;)
+	{
+		const int32 start = indexA;
+		const int32 count = GatherBatch(A.Left(num), indexA, batchA, false);
+		GatherBatch(B.Left(num), indexB, batchB, false);
+		LerpKernel(batchA, batchB, Alpha, OutValues.GetData() + start, count);
+	}
+}
+
+void FBpVariantKernels::CompareToScalar(const TConstArrayView<FBpVariant> Values, const double Scalar,
+                                        const EBpVariantComparison Comparison, TArray<bool>& OutResults)
+{
+	OutResults.SetNumUninitialized(Values.Num());
+
+	double batch[BatchSize];
+	for (int32 index = 0; index < Values.Num();)
+	{
+		const int32 start = index;
+		const int32 count = GatherBatch(Values, index, batch, false);
+		CompareKernel(batch, count, Scalar, Comparison, OutResults.GetData() + start);
+		for (int32 i = 0; i < count; ++i)
+		{
+			OutResults[start + i] &= IsNumber(Values[start + i].GetType());
+		}
+	}
+}
+
+double FBpVariantKernels::Sum(const FBpVariantArray& Values)
+{
+	return Sum(Values.GetFloat64s()) + Sum(Values.GetFloat32s()) + SumIntegers(Values.GetInt32s()) +
+		SumIntegers(Values.GetInt64s()) + SumIntegers(Values.GetBytes());
+}
+
+bool FBpVariantKernels::MinMax(const FBpVariantArray& Values, double& OutMin, double& OutMax)
+{
+	bool bFound = false;
+	double min;
+	double max;
+	if (MinMax(Values.GetFloat64s(), min, max))
+	{
+		CombineMinMax(min, max, OutMin, OutMax, bFound);
+	}
+	float minFloat;
+	float maxFloat;
+	if (MinMax(Values.GetFloat32s(), minFloat, maxFloat))
+	{
+		CombineMinMax(minFloat, maxFloat, OutMin, OutMax, bFound);
+	}
+	MinMaxIntegers(Values.GetInt32s(), OutMin, OutMax, bFound);
+	MinMaxIntegers(Values.GetInt64s(), OutMin, OutMax, bFound);
+	MinMaxIntegers(Values.GetBytes(), OutMin, OutMax, bFound);
+	return bFound;
+}
+
+void FBpVariantKernels::Scale(FBpVariantArray& Values, const double Factor)
+{
+	Scale(Values.GetMutableFloat64s(), Factor);
+	Scale(Values.GetMutableFloat32s(), static_cast<float>(Factor));
+	ScaleIntegers(Values.GetMutableInt32s(), Factor);
+	ScaleIntegers(Values.GetMutableInt64s(), Factor);
+	ScaleIntegers(Values.GetMutableBytes(), Factor);
+}
@@ -0,0 +1,779 @@
+#include "BpVariantTree.h"
+#include "Misc/Parse.h"
+#include "UObject/UnrealType.h"
+
+namespace
+{
+	// Slot states besides holding a node
+	constexpr int32 EmptySlot = INDEX_NONE;
+	constexpr int32 RemovedSlot = -2;
+
+	constexpr int32 MinCapacity = 4;
+}
+
+FBpVariantPath::FBpVariantPath(const FStringView Path)
+	: Source(Path)
+{
+	Parse();
+}
+
+void FBpVariantPath::PostSerialize(const FArchive& Ar)
+{
+	if (Ar.IsLoading())
+	{
+		Parse();
+	}
+}
+
+bool FBpVariantPath::ExportTextItem(FString& ValueStr, const FBpVariantPath& DefaultValue, UObject* Parent,
+                                    const int32 PortFlags, UObject* ExportRootScope) const
+{
+	ValueStr += TEXT("\"") + Source.ReplaceCharWithEscapedChar() + TEXT("\"");
+	return true;
+}
+
+bool FBpVariantPath::ImportTextItem(const TCHAR*& Buffer, const int32 PortFlags, UObject* Parent,
+                                    FOutputDevice* ErrorText)
+{
+	// Quoted as exported, or a bare path written by hand
+	FString path;
+	if (*Buffer == TEXT('"'))
+	{
+		int32 numRead = 0;
+		if (!FParse::QuotedString(Buffer, path, &numRead))
+		{
+			return false;
+		}
+		Buffer += numRead;
+	}
+	else
+	{
+		const TCHAR* end = FPropertyHelpers::ReadToken(Buffer, path, true);
+		if (end == nullptr)
+		{
+			return false;
+		}
+		Buffer = end;
+	}
+	Source = MoveTemp(path);
+	Parse();
+	return true;
+}
+
+void FBpVariantPath::Parse()
+{
+	Segments.Reset();
+	bValid = true;
+	const FStringView Path = Source;
+
+	int32 i = 0;
+	while (i < Path.Len())
+	{
+		if (Path[i] == TEXT('['))
+		{
+			int32 index = 0;
+			int32 digits = 0;
+			for (++i; i < Path.Len() && FChar::IsDigit(Path[i]) && digits < 9; ++i, ++digits)
+			{
+				index = index * 10 + (Path[i] - TEXT('0'));
+			}
+			if (digits == 0 || i >= Path.Len() || Path[i] != TEXT(']'))
+			{
+				bValid = false;
+				return;
+			}
+			Segments.Add({NAME_None, index});
+			++i;
+		}
+		else
+		{
+			// A key follows the start of the path or a dot
+			if (Path[i] == TEXT('.'))
+			{
+				if (Segments.IsEmpty())
+				{
+					bValid = false;
+					return;
+				}
+				++i;
+			}
+			else if (!Segments.IsEmpty())
+			{
+				bValid = false;
+				return;
+			}
+
+			const int32 start = i;
+			while (i < Path.Len() && Path[i] != TEXT('.') && Path[i] != TEXT('['))
+			{
+				++i;
+			}
+			if (i == start)
+			{
+				bValid = false;
+				return;
+			}
+			Segments.Add({FName(i - start, Path.GetData() + start), INDEX_NONE});
+		}
+	}
+}
+
+FBpVariantTree::FBpVariantTree(const EBpVariantNodeKind RootKind)
+{
+	AddNode(RootKind);
+}
+
+const FBpVariant* FBpVariantTree::TryGetValue(const int32 Node) const
+{
+	if (!IsValidNode(Node) || Nodes[Node].Kind != EBpVariantNodeKind::Value)
+	{
+		return nullptr;
+	}
+	return &Values[Nodes[Node].Offset];
+}
+
+bool FBpVariantTree::SetValue(const int32 Node, const FBpVariant& Value)
+{
+	if (!IsValidNode(Node) || Nodes[Node].Kind != EBpVariantNodeKind::Value)
+	{
+		return false;
+	}
+	Values[Nodes[Node].Offset] = Value;
+	return true;
+}
+
+int32 FBpVariantTree::FindChild(const int32 Object, const FName Key) const
+{
+	const int32 slot = FindSlot(Object, Key);
+	return slot != INDEX_NONE ? Slots[slot].Node : INDEX_NONE;
+}
+
+int32 FBpVariantTree::FindOrAddChild(const int32 Object, const FName Key, const EBpVariantNodeKind Kind,
+                                     const bool bReplace)
+{
+	if (!IsValidNode(Object) || Nodes[Object].Kind != EBpVariantNodeKind::Object)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 slot = FindSlot(Object, Key);
+	if (slot != INDEX_NONE)
+	{
+		const int32 child = Slots[slot].Node;
+		if (Nodes[child].Kind == Kind)
+		{
+			return child;
+		}
+		if (!bReplace)
+		{
+			return INDEX_NONE;
+		}
+		// The old child and everything under it is left for Compact
+		const int32 replacement = AddNode(Kind);
+		Slots[slot].Node = replacement;
+		return replacement;
+	}
+
+	const int32 child = AddNode(Kind);
+	InsertSlot(Object, Key, child);
+	return child;
+}
+
+bool FBpVariantTree::RemoveChild(const int32 Object, const FName Key)
+{
+	const int32 slot = FindSlot(Object, Key);
+	if (slot == INDEX_NONE)
+	{
+		return false;
+	}
+	// Removed rather than empty, so probing carries on past it
+	Slots[slot].Node = RemovedSlot;
+	--Nodes[Object].Num;
+	return true;
+}
+
+void FBpVariantTree::GetKeys(const int32 Object, TArray<FName>& OutKeys) const
+{
+	if (!IsValidNode(Object) || Nodes[Object].Kind != EBpVariantNodeKind::Object)
+	{
+		return;
+	}
+
+	const FNode& node = Nodes[Object];
+	OutKeys.Reserve(OutKeys.Num() + node.Num);
+	for (int32 i = node.Offset; i < node.Offset + node.Capacity; ++i)
+	{
+		if (Slots[i].Node >= 0)
+		{
+			OutKeys.Add(Slots[i].Key);
+		}
+	}
+}
+
+int32 FBpVariantTree::GetItem(const int32 List, const int32 Index) const
+{
+	if (!IsValidNode(List) || Nodes[List].Kind != EBpVariantNodeKind::List || Index < 0 || Index >= Nodes[List].Num)
+	{
+		return INDEX_NONE;
+	}
+	return Items[Nodes[List].Offset + Index];
+}
+
+int32 FBpVariantTree::AddItem(const int32 List, const EBpVariantNodeKind Kind)
+{
+	if (!IsValidNode(List) || Nodes[List].Kind != EBpVariantNodeKind::List)
+	{
+		return INDEX_NONE;
+	}
+	return FindOrAddItem(List, Nodes[List].Num, Kind);
+}
+
+int32 FBpVariantTree::FindOrAddItem(const int32 List, const int32 Index, const EBpVariantNodeKind Kind,
+                                    const bool bReplace)
+{
+	if (!IsValidNode(List) || Nodes[List].Kind != EBpVariantNodeKind::List || Index < 0 || Index > Nodes[List].Num)
+	{
+		return INDEX_NONE;
+	}
+
+	if (Index < Nodes[List].Num)
+	{
+		int32& item = Items[Nodes[List].Offset + Index];
+		if (Nodes[item].Kind == Kind)
+		{
+			return item;
+		}
+		if (!bReplace)
+		{
+			return INDEX_NONE;
+		}
+		const int32 replacement = AddNode(Kind);
+		// AddNode doesn't touch Items, so the reference is still good
+		item = replacement;
+		return replacement;
+	}
+
+	if (Nodes[List].Num == Nodes[List].Capacity)
+	{
+		GrowItems(List);
+	}
+	const int32 child = AddNode(Kind);
+	FNode& node = Nodes[List];
+	Items[node.Offset + node.Num++] = child;
+	return child;
+}
+
+bool FBpVariantTree::RemoveItem(const int32 List, const int32 Index)
+{
+	if (GetItem(List, Index) == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FNode& node = Nodes[List];
+	int32* items = Items.GetData() + node.Offset;
+	FMemory::Memmove(items + Index, items + Index + 1, (node.Num - Index - 1) * sizeof(int32));
+	--node.Num;
+	return true;
+}
+
+int32 FBpVariantTree::Find(const FBpVariantPath& Path) const
+{
+	if (!Path.IsValid())
+	{
+		return INDEX_NONE;
+	}
+
+	int32 node = Root;
+	for (const FBpVariantPathSegment& segment : Path.GetSegments())
+	{
+		node = segment.IsIndex() ? GetItem(node, segment.Index) : FindChild(node, segment.Key);
+		if (node == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+	}
+	return node;
+}
+
+int32 FBpVariantTree::FindOrAdd(const FBpVariantPath& Path, const EBpVariantNodeKind Kind)
+{
+	if (!Path.IsValid())
+	{
+		return INDEX_NONE;
+	}
+
+	const TConstArrayView<FBpVariantPathSegment> segments = Path.GetSegments();
+	if (segments.IsEmpty())
+	{
+		return Nodes[Root].Kind == Kind ? Root : INDEX_NONE;
+	}
+
+	int32 node = Root;
+	for (int32 i = 0; i < segments.Num() && node != INDEX_NONE; ++i)
+	{
+		// Steps along the way become whatever the next step needs
+		const bool bLast = i == segments.Num() - 1;
+		EBpVariantNodeKind kind = Kind;
+		if (!bLast)
+		{
+			kind = segments[i + 1].IsIndex() ? EBpVariantNodeKind::List : EBpVariantNodeKind::Object;
+		}
+		node = segments[i].IsIndex()
+			       ? FindOrAddItem(node, segments[i].Index, kind, bLast)
+			       : FindOrAddChild(node, segments[i].Key, kind, bLast);
+	}
+	return node;
+}
+
+bool FBpVariantTree::Remove(const FBpVariantPath& Path)
+{
+	const TConstArrayView<FBpVariantPathSegment> segments = Path.GetSegments();
+	if (!Path.IsValid() || segments.IsEmpty())
+	{
+		return false;
+	}
+
+	int32 parent = Root;
+	for (int32 i = 0; i < segments.Num() - 1 && parent != INDEX_NONE; ++i)
+	{
+		parent = segments[i].IsIndex() ? GetItem(parent, segments[i].Index) : FindChild(parent, segments[i].Key);
+	}
+	if (parent == INDEX_NONE)
+	{
+		return false;
+	}
+	const FBpVariantPathSegment& last = segments.Last();
+	return last.IsIndex() ? RemoveItem(parent, last.Index) : RemoveChild(parent, last.Key);
+}
+
+void FBpVariantTree::Reset()
+{
+	const EBpVariantNodeKind rootKind = Nodes[Root].Kind;
+	Nodes.Reset();
+	Values.Reset();
+	Slots.Reset();
+	Items.Reset();
+	AddNode(rootKind);
+}
+
+void FBpVariantTree::Compact()
+{
+	FBpVariantTree compacted(Nodes[Root].Kind);
+	compacted.Nodes.Reset();
+	compacted.Values.Reset();
+	compacted.Nodes.Reserve(Nodes.Num());
+	compacted.Values.Reserve(Values.Num());
+	compacted.CopyNode(*this, Root);
+
+	Nodes = MoveTemp(compacted.Nodes);
+	Values = MoveTemp(compacted.Values);
+	Slots = MoveTemp(compacted.Slots);
+	Items = MoveTemp(compacted.Items);
+}
+
+bool FBpVariantTree::Serialize(FArchive& Ar)
+{
+	Ar << Nodes;
+	Ar << Slots;
+	Ar << Items;
+
+	int32 numValues = Values.Num();
+	Ar << numValues;
+	if (Ar.IsLoading())
+	{
+		Values.SetNum(numValues);
+	}
+	for (FBpVariant& value : Values)
+	{
+		value.Serialize(Ar);
+	}
+
+	if (Ar.IsLoading() && !IsValidStorage())
+	{
+		// The offsets can't be trusted, so the tree is left empty rather than read out of bounds
+		Ar.SetError();
+		const EBpVariantNodeKind rootKind = Nodes.IsEmpty() ? EBpVariantNodeKind::Object : Nodes[Root].Kind;
+		Nodes.Reset();
+		Values.Reset();
+		Slots.Reset();
+		Items.Reset();
+		AddNode(rootKind);
+	}
+	return true;
+}
+
+void FBpVariantTree::AddStructReferencedObjects(FReferenceCollector& Collector)
+{
+	// Removed values are reported too, they're only dropped by Compact
+	for (FBpVariant& value : Values)
+	{
+		value.AddStructReferencedObjects(Collector);
+	}
+}
+
+bool FBpVariantTree::Identical(const FBpVariantTree* Other, uint32 PortFlags) const
+{
+	if (!Other)
+	{
+		return false;
+	}
+
+	// Walked with a stack of node pairs, like CopyNode
+	TArray<TPair<int32, int32>> pending;
+	pending.Add({Root, Root});
+	while (!pending.IsEmpty())
+	{
+		const TPair<int32, int32> next = pending.Pop(EAllowShrinking::No);
+		const FNode& node = Nodes[next.Key];
+		const FNode& otherNode = Other->Nodes[next.Value];
+		if (node.Kind != otherNode.Kind || node.Num != otherNode.Num)
+		{
+			return false;
+		}
+
+		switch (node.Kind)
+		{
+		case EBpVariantNodeKind::Value:
+			if (Values[node.Offset] != Other->Values[otherNode.Offset])
+			{
+				return false;
+			}
+			break;
+		case EBpVariantNodeKind::Object:
+			// Same number of keys, so finding each of ours in the other object covers all of theirs
+			for (int32 i = node.Offset; i < node.Offset + node.Capacity; ++i)
+			{
+				if (Slots[i].Node >= 0)
+				{
+					const int32 otherChild = Other->FindChild(next.Value, Slots[i].Key);
+					if (otherChild == INDEX_NONE)
+					{
+						return false;
+					}
+					pending.Add({Slots[i].Node, otherChild});
+				}
+			}
+			break;
+		case EBpVariantNodeKind::List:
+			for (int32 i = 0; i < node.Num; ++i)
+			{
+				pending.Add({Items[node.Offset + i], Other->Items[otherNode.Offset + i]});
+			}
+			break;
+		}
+	}
+	return true;
+}
+
+int32 FBpVariantTree::AddNode(const EBpVariantNodeKind Kind)
+{
+	FNode node;
+	node.Kind = Kind;
+	if (Kind == EBpVariantNodeKind::Value)
+	{
+		node.Offset = Values.AddDefaulted();
+	}
+	return Nodes.Add(node);
+}
+
+int32 FBpVariantTree::FindSlot(const int32 Object, const FName Key) const
+{
+	if (!IsValidNode(Object) || Nodes[Object].Kind != EBpVariantNodeKind::Object || Nodes[Object].Capacity == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	const FNode& node = Nodes[Object];
+	const uint32 mask = node.Capacity - 1;
+	const FSlot* slots = Slots.GetData() + node.Offset;
+	uint32 i = GetTypeHash(Key) & mask;
+	for (int32 probes = 0; probes < node.Capacity; ++probes)
+	{
+		if (slots[i].Node == EmptySlot)
+		{
+			return INDEX_NONE;
+		}
+		if (slots[i].Node != RemovedSlot && slots[i].Key == Key)
+		{
+			return node.Offset + i;
+		}
+		i = (i + 1) & mask;
+	}
+	return INDEX_NONE;
+}
+
+void FBpVariantTree::InsertSlot(const int32 Object, const FName Key, const int32 Child)
+{
+	// Kept under three quarters full, counting removed slots since they lengthen probes just the same
+	if ((Nodes[Object].Used + 1) * 4 > Nodes[Object].Capacity * 3)
+	{
+		const int32 capacity = Nodes[Object].Capacity;
+		GrowSlots(Object, (Nodes[Object].Num + 1) * 2 > capacity ? FMath::Max(capacity * 2, MinCapacity) : capacity);
+	}
+
+	FNode& node = Nodes[Object];
+	const uint32 mask = node.Capacity - 1;
+	FSlot* slots = Slots.GetData() + node.Offset;
+	uint32 i = GetTypeHash(Key) & mask;
+	while (slots[i].Node >= 0)
+	{
+		i = (i + 1) & mask;
+	}
+	node.Used += slots[i].Node == EmptySlot ? 1 : 0;
+	++node.Num;
+	slots[i] = {Key, Child};
+}
+
+void FBpVariantTree::GrowSlots(const int32 Object, const int32 Capacity)
+{
+	// Tables only ever move to the end of Slots, the old one is left for Compact
+	const int32 offset = Slots.Num();
+	Slots.AddDefaulted(Capacity);
+
+	FNode& node = Nodes[Object];
+	const uint32 mask = Capacity - 1;
+	FSlot* slots = Slots.GetData() + offset;
+	for (int32 old = node.Offset; old < node.Offset + node.Capacity; ++old)
+	{
+		const FSlot& slot = Slots[old];
+		if (slot.Node >= 0)
+		{
+			uint32 i = GetTypeHash(slot.Key) & mask;
+			while (slots[i].Node != EmptySlot)
+			{
+				i = (i + 1) & mask;
+			}
+			slots[i] = slot;
+		}
+	}
+	node.Offset = offset;
+	node.Capacity = Capacity;
+	node.Used = node.Num;
+}
+
+void FBpVariantTree::GrowItems(const int32 List)
+{
+	FNode& node = Nodes[List];
+	const int32 capacity = FMath::Max(node.Capacity * 2, MinCapacity);
+
+	// The list at the end of Items can grow in place
+	if (node.Offset + node.Capacity == Items.Num() && node.Capacity > 0)
+	{
+		Items.AddZeroed(capacity - node.Capacity);
+	}
+	else
+	{
+		const int32 offset = Items.Num();
+		Items.AddZeroed(capacity);
+		FMemory::Memcpy(Items.GetData() + offset, Items.GetData() + node.Offset, node.Num * sizeof(int32));
+		node.Offset = offset;
+	}
+	node.Capacity = capacity;
+}
+
+int32 FBpVariantTree::CopyNode(const FBpVariantTree& Source, const int32 SourceNode)
+{
+	// Walked with a stack rather than recursion, so a deep tree can't run out of call stack
+	struct FPending
+	{
+		int32 SourceNode;
+		int32 Parent;
+		FName Key;
+		int32 Index;
+	};
+	TArray<FPending> pending;
+	pending.Add({SourceNode, INDEX_NONE, NAME_None, INDEX_NONE});
+
+	int32 result = INDEX_NONE;
+	while (!pending.IsEmpty())
+	{
+		const FPending next = pending.Pop(EAllowShrinking::No);
+		const FNode& source = Source.Nodes[next.SourceNode];
+		const int32 copy = AddNode(source.Kind);
+		if (next.Parent == INDEX_NONE)
+		{
+			result = copy;
+		}
+		else if (Nodes[next.Parent].Kind == EBpVariantNodeKind::Object)
+		{
+			InsertSlot(next.Parent, next.Key, copy);
+		}
+		else
+		{
+			Items[Nodes[next.Parent].Offset + next.Index] = copy;
+		}
+
+		switch (source.Kind)
+		{
+		case EBpVariantNodeKind::Value:
+			Values[Nodes[copy].Offset] = Source.Values[source.Offset];
+			break;
+		case EBpVariantNodeKind::Object:
+			if (source.Num > 0)
+			{
+				// Sized up front so inserting the children never grows the table again
+				const uint32 capacity = FMath::RoundUpToPowerOfTwo(source.Num * 2);
+				GrowSlots(copy, FMath::Max(static_cast<int32>(capacity), MinCapacity));
+				for (int32 i = source.Offset; i < source.Offset + source.Capacity; ++i)
+				{
+					if (Source.Slots[i].Node >= 0)
+					{
+						pending.Add({Source.Slots[i].Node, copy, Source.Slots[i].Key, INDEX_NONE});
+					}
+				}
+			}
+			break;
+		case EBpVariantNodeKind::List:
+			if (source.Num > 0)
+			{
+				// Items are filled in by index as they're copied, pushed in reverse to keep the nodes in order
+				FNode& node = Nodes[copy];
+				node.Offset = Items.Num();
+				node.Capacity = FMath::Max(static_cast<int32>(FMath::RoundUpToPowerOfTwo(source.Num)), MinCapacity);
+				node.Num = source.Num;
+				Items.AddZeroed(node.Capacity);
+				for (int32 i = source.Num - 1; i >= 0; --i)
+				{
+					pending.Add({Source.Items[source.Offset + i], copy, NAME_None, i});
+				}
+			}
+			break;
+		}
+	}
+	return result;
+}
+
+bool FBpVariantTree::IsValidStorage() const
+{
+	if (Nodes.IsEmpty())
+	{
+		return false;
+	}
+
+	for (const FNode& node : Nodes)
+	{
+		switch (node.Kind)
+		{
+		case EBpVariantNodeKind::Value:
+			if (!Values.IsValidIndex(node.Offset))
+			{
+				return false;
+			}
+			break;
+		case EBpVariantNodeKind::Object:
+			if (node.Capacity < 0 || !FMath::IsPowerOfTwo(FMath::Max(node.Capacity, 1)) || node.Offset < 0 ||
+				node.Offset > Slots.Num() - node.Capacity || node.Num < 0 || node.Num > node.Used ||
+				node.Used > node.Capacity || (node.Used == node.Capacity && node.Capacity > 0))
+			{
+				return false;
+			}
+			break;
+		case EBpVariantNodeKind::List:
+			if (node.Num < 0 || node.Num > node.Capacity || node.Offset < 0 ||
+				node.Offset > Items.Num() - node.Capacity)
+			{
+				return false;
+			}
+			break;
+		default:
+			return false;
+		}
+	}
+
+	for (const FSlot& slot : Slots)
+	{
+		if (slot.Node < RemovedSlot || slot.Node >= Nodes.Num())
+		{
+			return false;
+		}
+	}
+	for (const int32 item : Items)
+	{
+		if (item < 0 || item >= Nodes.Num())
+		{
+			return false;
+		}
+	}
+
+	/*
+	Everything reachable from the root must have exactly one parent and its own value, which rules out cycles and
+	shared children. Reachable tables never overlap, so their capacities can't add up to more than the arrays hold.
+	*/
+	TBitArray<> visitedNodes(false, Nodes.Num());
+	TBitArray<> visitedValues(false, Values.Num());
+	int32 slotsLeft = Slots.Num();
+	int32 itemsLeft = Items.Num();
+	TArray<int32> pending;
+	pending.Add(Root);
+	visitedNodes[Root] = true;
+
+	const auto visit = [&visitedNodes, &pending](const int32 Child)
+	{
+		if (visitedNodes[Child])
+		{
+			return false;
+		}
+		visitedNodes[Child] = true;
+		pending.Add(Child);
+		return true;
+	};
+
+	while (!pending.IsEmpty())
+	{
+		const FNode& node = Nodes[pending.Pop(EAllowShrinking::No)];
+		switch (node.Kind)
+		{
+		case EBpVariantNodeKind::Value:
+			if (visitedValues[node.Offset])
+			{
+				return false;
+			}
+			visitedValues[node.Offset] = true;
+			break;
+		case EBpVariantNodeKind::Object:
+			{
+				slotsLeft -= node.Capacity;
+				if (slotsLeft < 0)
+				{
+					return false;
+				}
+				int32 num = 0;
+				int32 used = 0;
+				for (int32 i = node.Offset; i < node.Offset + node.Capacity; ++i)
+				{
+					const int32 child = Slots[i].Node;
+					used += child != EmptySlot ? 1 : 0;
+					if (child >= 0)
+					{
+						++num;
+						if (!visit(child))
+						{
+							return false;
+						}
+					}
+				}
+				if (num != node.Num || used != node.Used)
+				{
+					return false;
+				}
+			}
+			break;
+		case EBpVariantNodeKind::List:
+			itemsLeft -= node.Capacity;
+			if (itemsLeft < 0)
+			{
+				return false;
+			}
+			for (int32 i = node.Offset; i < node.Offset + node.Num; ++i)
+			{
+				if (!visit(Items[i]))
+				{
+					return false;
+				}
+			}
+			break;
+		}
+	}
+	return true;
+}
@@ -4,6 +4,7 @@
 #include "UObject/Interface.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "ValueType.h"
+#include "BoxedValueCache.h"
 #include "BoxedValue.generated.h"
 
 // This class does not need to be modified.
@@ -24,6 +25,18 @@ class BPVALUEBOX_API IBoxedType
 public:
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	EValueType GetType();
+
+	// Puts the value back to its default so the box can be pooled and reused
+	virtual void ResetValue()
+	{
+	}
+
+	// Reads the type of native boxes directly instead of dispatching the GetType event. None if the box didn't set it.
+	EValueType GetNativeType() const { return NativeType; }
+
+protected:
+	// Native boxes set this in their constructor, Blueprint implementations only have GetType
+	EValueType NativeType = EValueType::None;
 };
 
 /* A struct wrapper around an IBoxedType. */
@@ -42,23 +55,164 @@ class BPVALUEBOX_API UBoxedValueStatics : public UBlueprintFunctionLibrary
 	GENERATED_BODY()
 
 public:
+	// Common values come back as shared canonical boxes unless bUnique is set, see FBoxedValueCache
 	template <typename TBoxType, typename TValueType>
-	static TBoxType* BoxValue(UObject* Context, const TValueType& Value)
+	static TBoxType* BoxValue(UObject* Context, const TValueType& Value, const bool bUnique = false)
 	{
-		TBoxType* box = NewObject<TBoxType>(Context);
+		if (!bUnique && FBoxedValueCache::IsEnabled())
+		{
+			if (UObject* interned = FBoxedValueCache::Find(TBoxType::StaticClass(), Value))
+			{
+				return static_cast<TBoxType*>(interned);
+			}
+		}
+
+		TBoxType* box = static_cast<TBoxType*>(AcquireBox(Context, TBoxType::StaticClass()));
 		box->Value = Value;
 		return box;
 	}
 
+	// Boxes the value and hands the box back to the pool at the end of this frame's actor tick
+	template <typename TBoxType, typename TValueType>
+	static TBoxType* BoxFrameValue(UObject* Context, const TValueType& Value)
+	{
+		TBoxType* box = BoxValue<TBoxType>(Context, Value, true);
+		ReleaseBoxAtEndOfFrame(Context, box);
+		return box;
+	}
+
+	/*
+	Boxes every value in one go. Common values still come back as shared boxes unless bUnique is set, and the rest are
+	taken from the pool together instead of one at a time.
+	*/
+	template <typename TBoxType>
+	static void BoxArray(UObject* Context, const TConstArrayView<decltype(TBoxType::Value)> Values,
+	                     TArray<TScriptInterface<IBoxedType>>& OutBoxes, const bool bUnique = false)
+	{
+		OutBoxes.Reset(Values.Num());
+		OutBoxes.SetNum(Values.Num());
+
+		const bool bIntern = !bUnique && FBoxedValueCache::IsEnabled();
+		TArray<int32> newBoxIndices;
+		for (int32 i = 0; i < Values.Num(); ++i)
+		{
+			if (UObject* interned = bIntern ? FBoxedValueCache::Find(TBoxType::StaticClass(), Values[i]) : nullptr)
+			{
+				OutBoxes[i] = interned;
+			}
+			else
+			{
+				newBoxIndices.Add(i);
+			}
+		}
+
+		TArray<UObject*> newBoxes;
+		newBoxes.SetNumUninitialized(newBoxIndices.Num());
+		AcquireBoxes(Context, TBoxType::StaticClass(), newBoxes);
+		for (int32 i = 0; i < newBoxIndices.Num(); ++i)
+		{
+			TBoxType* box = static_cast<TBoxType*>(newBoxes[i]);
+			box->Value = Values[newBoxIndices[i]];
+			OutBoxes[newBoxIndices[i]] = box;
+		}
+	}
+
+	// Boxes of another kind unbox as a default value. Returns how many held the right kind.
+	template <typename TBoxType>
+	static int32 UnboxArray(const TConstArrayView<TScriptInterface<IBoxedType>> Boxes,
+	                        TArray<decltype(TBoxType::Value)>& OutValues)
+	{
+		OutValues.Reset(Boxes.Num());
+		int32 numUnboxed = 0;
+		for (const TScriptInterface<IBoxedType>& box : Boxes)
+		{
+			if (const decltype(TBoxType::Value)* value = TryGetValuePtr<TBoxType>(box))
+			{
+				OutValues.Add(*value);
+				++numUnboxed;
+			}
+			else
+			{
+				OutValues.AddDefaulted();
+			}
+		}
+		return numUnboxed;
+	}
+
+	// Takes a box from the world's UBoxedValuePool, or creates a new one when the context has no world
+	static UObject* AcquireBox(UObject* Context, UClass* BoxClass);
+
+	// Fills OutBoxes with boxes of the class, taking as many as the pool has at once
+	static void AcquireBoxes(UObject* Context, UClass* BoxClass, TArrayView<UObject*> OutBoxes);
+
+	// Returns the box to the world's pool. Nothing may use the box afterward since it will get reused.
+	UFUNCTION(BlueprintCallable, meta = ( DefaultToSelf = Context ), Category="BoxedValue")
+	static void ReleaseBox(UObject* Context, const TScriptInterface<IBoxedType>& Box);
+
+	// Returns the box to the world's pool once this frame's actor tick has finished
+	UFUNCTION(BlueprintCallable, meta = ( DefaultToSelf = Context ), Category="BoxedValue")
+	static void ReleaseBoxAtEndOfFrame(UObject* Context, const TScriptInterface<IBoxedType>& Box);
+
+	// Reads the native type when the box has one and only falls back to the GetType event for custom implementations
+	static EValueType GetBoxType(const TScriptInterface<IBoxedType>& Box)
+	{
+		if (const IBoxedType* boxedType = Box.GetInterface())
+		{
+			if (boxedType->GetNativeType() != EValueType::None)
+			{
+				return boxedType->GetNativeType();
+			}
+		}
+		UObject* object = Box.GetObject();
+		return object ? IBoxedType::Execute_GetType(object) : EValueType::None;
+	}
+
+	// Final box classes can't be subclassed, so checking the class resolves the cast with a single compare
+	template <typename TBoxedType>
+	static TBoxedType* CastBox(UObject* Box)
+	{
+		if constexpr (std::is_final_v<TBoxedType>)
+		{
+			return Box && Box->GetClass() == TBoxedType::StaticClass() ? static_cast<TBoxedType*>(Box) : nullptr;
+		}
+		else
+		{
+			return Cast<TBoxedType>(Box);
+		}
+	}
+
 	template <typename TReturnType, typename TBoxedType>
 	static TReturnType GetValue(const TScriptInterface<IBoxedType>& Value)
 	{
-		if (TBoxedType* box = Cast<TBoxedType>(Value.GetObject()))
+		if (TBoxedType* box = CastBox<TBoxedType>(Value.GetObject()))
 		{
 			return box->Value;
 		}
 		return TReturnType();
 	}
+
+	// Points at the value inside of the box, or returns nullptr if it is a different kind of box
+	template <typename TBoxedType>
+	static const decltype(TBoxedType::Value)* TryGetValuePtr(const TScriptInterface<IBoxedType>& Value)
+	{
+		if (const TBoxedType* box = CastBox<TBoxedType>(Value.GetObject()))
+		{
+			return &box->Value;
+		}
+		return nullptr;
+	}
+
+	// Only writes to OutValue when the box holds a value, so nothing gets default constructed on failure
+	template <typename TBoxedType, typename TReturnType>
+	static bool TryUnbox(const TScriptInterface<IBoxedType>& Value, TReturnType& OutValue)
+	{
+		if (const TBoxedType* box = CastBox<TBoxedType>(Value.GetObject()))
+		{
+			OutValue = box->Value;
+			return true;
+		}
+		return false;
+	}
 };
 
 UCLASS(Blueprintable)
@@ -71,10 +225,13 @@ public:
 
 	virtual EValueType GetType_Implementation() override { return EValueType::String; }
 
+	virtual void ResetValue() override { Value = FVariant(); }
+
 	template <typename TVariant>
 	static UBoxedVariant* BoxVariant(UObject* Context, TVariant Value)
 	{
-		UBoxedVariant* box = NewObject<UBoxedVariant>(Context);
+		UBoxedVariant* box = static_cast<UBoxedVariant*>(UBoxedValueStatics::AcquireBox(
+			Context, UBoxedVariant::StaticClass()));
 		box->Value = Value;
 		return box;
 	}
@@ -82,7 +239,7 @@ public:
 	template <typename TReturnType>
 	static TReturnType AsVariant(const TScriptInterface<IBoxedType>& Value)
 	{
-		if (UBoxedVariant* box = Cast<UBoxedVariant>(Value.GetObject()))
+		if (UBoxedVariant* box = UBoxedValueStatics::CastBox<UBoxedVariant>(Value.GetObject()))
 		{
 			return box->Value.GetValue<TReturnType>();
 		}
@@ -126,10 +283,16 @@ class BPVALUEBOX_API UBoxedObject : public UObject, public IBoxedType
 	GENERATED_BODY()
 
 public:
+	static constexpr EValueType StaticType = EValueType::Object;
+
 	UPROPERTY(BlueprintReadWrite)
 	UObject* Value = nullptr;
 
-	virtual EValueType GetType_Implementation() override { return EValueType::Object; }
+	UBoxedObject() { NativeType = StaticType; }
+
+	virtual EValueType GetType_Implementation() override { return StaticType; }
+
+	virtual void ResetValue() override { Value = nullptr; }
 
 	UFUNCTION(BlueprintCallable, meta = ( DefaultToSelf = Context ), Category="BoxedValue")
 	static UBoxedObject* BoxObject(UObject* Context, UObject* Input)
@@ -140,7 +303,7 @@ public:
 	UFUNCTION(BlueprintPure, Category="BoxedValue")
 	static UObject* AsObject(const TScriptInterface<IBoxedType>& Input)
 	{
-		UBoxedObject* box = Cast<UBoxedObject>(Input.GetObject());
+		UBoxedObject* box = UBoxedValueStatics::CastBox<UBoxedObject>(Input.GetObject());
 		if (box)
 		{
 			return box->Value;
@@ -155,10 +318,16 @@ class BPVALUEBOX_API UBoxedTransform : public UObject, public IBoxedType
 	GENERATED_BODY()
 
 public:
+	static constexpr EValueType StaticType = EValueType::Transform;
+
 	UPROPERTY(BlueprintReadWrite)
 	FTransform Value = FTransform();
 
-	virtual EValueType GetType_Implementation() override { return EValueType::Transform; }
+	UBoxedTransform() { NativeType = StaticType; }
+
+	virtual EValueType GetType_Implementation() override { return StaticType; }
+
+	virtual void ResetValue() override { Value = FTransform(); }
 
 	UFUNCTION(BlueprintCallable, meta = ( DefaultToSelf = Context ), Category="BoxedValue")
 	static UBoxedTransform* BoxVector(UObject* Context, FTransform Input)
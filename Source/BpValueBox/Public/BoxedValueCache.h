@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+Canonical boxes for the values that get boxed the most, akin to Java's Integer cache.
+UBoxedValueStatics::BoxValue returns these instead of creating a new box. They are rooted and shared by every caller,
+so their Value must never be written to, and Blueprint writes to them are refused. Pass bUnique when boxing a value
+that is going to be changed.
+*/
+class BPVALUEBOX_API FBoxedValueCache
+{
+public:
+	static constexpr int32 MinCachedInteger = -128;
+	static constexpr int32 MaxCachedInteger = 1023;
+
+	// Whether BoxValue should use the cache at all, see UBpValueBoxSettings::bInternCommonValues
+	static bool IsEnabled();
+
+	// Whether the box is one of the shared canonical boxes
+	static bool IsInterned(const UObject* Box);
+
+	// Logs and returns false for the shared canonical boxes, which every caller would see the write to
+	static bool CanWrite(const UObject* Box);
+
+	// Lets go of every canonical box, for module shutdown
+	static void Reset();
+
+	// Each of these returns the canonical box of BoxClass for the value, or nullptr if the value isn't cached
+	static UObject* Find(const UClass* BoxClass, bool Value);
+	static UObject* Find(const UClass* BoxClass, uint8 Value);
+	static UObject* Find(const UClass* BoxClass, int32 Value);
+	static UObject* Find(const UClass* BoxClass, int64 Value);
+	static UObject* Find(const UClass* BoxClass, float Value);
+	static UObject* Find(const UClass* BoxClass, double Value);
+	static UObject* Find(const UClass* BoxClass, const FName& Value);
+	static UObject* Find(const UClass* BoxClass, const FString& Value);
+	static UObject* Find(const UClass* BoxClass, const FVector& Value);
+	static UObject* Find(const UClass* BoxClass, const FRotator& Value);
+
+	template <typename TValueType>
+	static UObject* Find(const UClass* BoxClass, const TValueType& Value)
+	{
+		return nullptr;
+	}
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BoxedValue.h"
+#include "BoxedValuePool.generated.h"
+
+USTRUCT()
+struct FBoxedValuePoolBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<UObject>> Boxes;
+};
+
+/*
+Recycles the boxes of a world so boxing a short-lived value doesn't need a new UObject every time.
+Released boxes are reset and kept alive by the pool until UBoxedValueStatics::BoxValue hands them out again.
+Only release a box once nothing else holds on to it, since it will be reused for another value.
+The pool is game thread only. Get returns nullptr on other threads, so boxing there creates a new box and releasing
+it does nothing.
+*/
+UCLASS()
+class BPVALUEBOX_API UBoxedValuePool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UBoxedValuePool* Get(const UObject* Context);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Reuses a released box of the given class, or creates a new one if there are none left
+	UObject* Acquire(UClass* BoxClass);
+
+	// Same as calling Acquire for every element, but takes the pooled boxes off the bucket in one go
+	void AcquireMany(UClass* BoxClass, TArrayView<UObject*> OutBoxes);
+
+	// Resets the box and puts it back into the pool. Releasing a box that is already pooled does nothing.
+	void Release(UObject* Box);
+
+	// Keeps the box alive until the end of this frame's actor tick, then releases it
+	void ReleaseAtEndOfFrame(UObject* Box);
+
+	int32 GetNumPooled(const UClass* BoxClass) const;
+
+private:
+	void HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FBoxedValuePoolBucket> Buckets;
+
+	UPROPERTY()
+	TArray<TObjectPtr<UObject>> FrameBoxes;
+
+	// The boxes in Buckets, so a box released twice isn't handed out twice
+	TSet<TObjectKey<UObject>> PooledBoxes;
+
+	FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Algo/BinarySearch.h"
+#include "Containers/BitArray.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "BpVariant.h"
+#include "BpObservableVariant.generated.h"
+
+/*
+A variant that counts its changes, so consumers can compare a version instead of comparing the value itself.
+Setting a value equal to the current one isn't a change.
+*/
+USTRUCT(BlueprintType)
+struct BPVALUEBOX_API FBpObservableVariant
+{
+	GENERATED_BODY()
+
+	const FBpVariant& Get() const { return Value; }
+
+	// 0 until the first change
+	uint64 GetVersion() const { return Version; }
+
+	bool HasChangedSince(const uint64 SinceVersion) const { return Version > SinceVersion; }
+
+	// Returns whether the value changed
+	bool Set(const FBpVariant& NewValue) { return Set(NewValue, Version + 1); }
+
+	// Stamps the change with NewVersion instead of counting up, for containers that number changes across values
+	bool Set(const FBpVariant& NewValue, uint64 NewVersion);
+
+	// For changing the value in place, which always counts as a change
+	FBpVariant& Modify() { return Modify(Version + 1); }
+	FBpVariant& Modify(uint64 NewVersion);
+
+	// A loaded value counts as a change
+	void PostSerialize(const FArchive& Ar);
+
+private:
+	UPROPERTY(EditAnywhere, Category="BpVariant")
+	FBpVariant Value;
+
+	uint64 Version = 0;
+};
+
+template <>
+struct TStructOpsTypeTraits<FBpObservableVariant> : public TStructOpsTypeTraitsBase2<FBpObservableVariant>
+{
+	enum
+	{
+		WithPostSerialize = true,
+	};
+};
+
+/*
+Variants in numbered slots that remember which slots changed. One counter numbers the changes to every slot, so a
+consumer keeps the version it last saw and only visits the slots changed since then, however many slots there are.
+The dirty bits track the same changes for a single consumer that clears them, such as replication.
+*/
+USTRUCT(BlueprintType)
+struct BPVALUEBOX_API FBpObservableVariantList
+{
+	GENERATED_BODY()
+
+	// Loaded deltas claiming more slots than this are rejected as corrupt rather than allocated
+	static constexpr uint32 MaxDeltaSlots = 1 << 16;
+
+	int32 Num() const { return Slots.Num(); }
+
+	const FBpVariant& Get(const int32 Index) const { return Slots[Index].Get(); }
+
+	// Version of the latest change to any slot
+	uint64 GetVersion() const { return Version; }
+
+	uint64 GetSlotVersion(const int32 Index) const { return Slots[Index].GetVersion(); }
+
+	/*
+	Adds empty slots, which count as changed, or removes slots from the end. Removing slots raises the version without
+	reporting any slot, so consumers comparing versions still send the new size.
+	*/
+	void SetNum(int32 NewNum);
+
+	// Returns whether the slot's value changed
+	bool Set(int32 Index, const FBpVariant& Value);
+
+	// For changing a slot's value in place, which always counts as a change
+	FBpVariant& Modify(int32 Index);
+
+	// Calls Func(Index, Value) for every slot changed after SinceVersion, in the order of their latest change
+	template <typename TFunc>
+	void ForEachChangedSince(const uint64 SinceVersion, TFunc&& Func) const
+	{
+		// The journal is in version order, so the changes after SinceVersion are all at its end
+		const int32 first = Algo::UpperBoundBy(Journal, SinceVersion, &FChange::Version);
+		for (int32 i = first; i < Journal.Num(); ++i)
+		{
+			// A slot changed again later has a newer entry further on
+			const FChange& change = Journal[i];
+			if (change.Slot < Slots.Num() && Slots[change.Slot].GetVersion() == change.Version)
+			{
+				Invoke(Func, change.Slot, Slots[change.Slot].Get());
+			}
+		}
+	}
+
+	TArray<int32> GetChangedSince(uint64 SinceVersion) const;
+
+	const TBitArray<>& GetDirtyBits() const { return DirtyBits; }
+	bool IsDirty() const { return DirtyBits.Contains(true); }
+	void ClearDirty();
+
+	/*
+	Saving writes the number of slots and every slot changed after InOutVersion, then sets InOutVersion to the list's
+	version so it can be passed back in for the next delta. Loading applies a delta through Set, so this list's own
+	consumers see the changes, and sets InOutVersion to the version of the list it was written from.
+	*/
+	bool SerializeDelta(FArchive& Ar, uint64& InOutVersion);
+
+	// A loaded list counts every slot as changed
+	void PostSerialize(const FArchive& Ar);
+
+private:
+	struct FChange
+	{
+		int32 Slot;
+		uint64 Version;
+	};
+
+	void RecordChange(int32 Index);
+
+	UPROPERTY(EditAnywhere, Category="BpVariant")
+	TArray<FBpObservableVariant> Slots;
+
+	uint64 Version = 0;
+
+	// The changes in version order. Entries replaced by a later change to the same slot are dropped now and then.
+	TArray<FChange> Journal;
+
+	TBitArray<> DirtyBits;
+};
+
+template <>
+struct TStructOpsTypeTraits<FBpObservableVariantList> : public TStructOpsTypeTraitsBase2<FBpObservableVariantList>
+{
+	enum
+	{
+		WithPostSerialize = true,
+	};
+};
+
+UCLASS()
+class BPVALUEBOX_API UBpObservableVariantStatics : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	// Returns whether the value changed
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Observable")
+	static bool SetObservableValue(UPARAM(ref) FBpObservableVariant& Observable, const FBpVariant& Value)
+	{
+		return Observable.Set(Value);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Observable")
+	static FBpVariant GetObservableValue(const FBpObservableVariant& Observable)
+	{
+		return Observable.Get();
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Observable")
+	static int64 GetObservableVersion(const FBpObservableVariant& Observable)
+	{
+		return static_cast<int64>(Observable.GetVersion());
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Observable")
+	static void SetObservableListNum(UPARAM(ref) FBpObservableVariantList& List, const int32 Num)
+	{
+		List.SetNum(FMath::Max(Num, 0));
+	}
+
+	// Returns whether the slot's value changed. Does nothing for an index outside of the list.
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Observable")
+	static bool SetObservableListValue(UPARAM(ref) FBpObservableVariantList& List, const int32 Index,
+	                                   const FBpVariant& Value)
+	{
+		return Index >= 0 && Index < List.Num() && List.Set(Index, Value);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Observable")
+	static FBpVariant GetObservableListValue(const FBpObservableVariantList& List, const int32 Index)
+	{
+		return Index >= 0 && Index < List.Num() ? List.Get(Index) : FBpVariant();
+	}
+
+	// Returns the list's version, to pass back in as SinceVersion next time
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Observable")
+	static int64 GetObservableListChanges(const FBpObservableVariantList& List, const int64 SinceVersion,
+	                                      TArray<int32>& ChangedIndices)
+	{
+		ChangedIndices = List.GetChangedSince(static_cast<uint64>(FMath::Max<int64>(SinceVersion, 0)));
+		return static_cast<int64>(List.GetVersion());
+	}
+};
@@ -2,8 +2,11 @@
 
 #pragma once
 
+#include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+BPVALUEBOX_API DECLARE_LOG_CATEGORY_EXTERN(LogBpValueBox, Log, All);
+
 class FBpValueBoxModule : public IModuleInterface
 {
 public:
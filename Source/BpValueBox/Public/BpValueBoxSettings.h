@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "BpValueBoxSettings.generated.h"
+
+/* How FBpVariant quantizes vectors when it is replicated. These match the FVector_NetQuantize types. */
+UENUM()
+enum class EBpVariantVectorQuantization : uint8
+{
+	None,
+	Whole,
+	OneDecimal,
+	TwoDecimals,
+};
+
+/* How typed variant getters treat a variant that holds another type. */
+UENUM()
+enum class EBpVariantAccess : uint8
+{
+	// Whatever DefaultAccess is set to in DefaultValueBox.ini. Blueprint getters are always checked.
+	Default,
+	// Checks the type first, logging and counting mismatches
+	Checked,
+	// Reads the value without looking at the type. This is a raw load in shipping builds, so only use it where the
+	// type is known. Development builds still assert on a mismatch.
+	Unchecked,
+};
+
+/* Module-wide settings, read from the [/Script/BpValueBox.BpValueBoxSettings] section of DefaultValueBox.ini. */
+UCLASS(config=ValueBox, defaultconfig)
+class BPVALUEBOX_API UBpValueBoxSettings : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	// How many released boxes of each class a world keeps around for reuse. Anything past this is left to the GC.
+	UPROPERTY(config, EditAnywhere, Category="BoxedValue")
+	int32 MaxPooledBoxesPerClass = 1024;
+
+	// Whether boxing common values such as booleans, small integers and empty strings returns shared canonical boxes
+	UPROPERTY(config, EditAnywhere, Category="BoxedValue")
+	bool bInternCommonValues = true;
+
+	// Precision of vectors when an FBpVariant is replicated. Saving always keeps full precision.
+	UPROPERTY(config, EditAnywhere, Category="BpVariant")
+	EBpVariantVectorQuantization VectorQuantization = EBpVariantVectorQuantization::None;
+
+	// Whether rotators are replicated as 16 bit shorts per axis instead of full precision
+	UPROPERTY(config, EditAnywhere, Category="BpVariant")
+	bool bCompressRotators = false;
+
+	// Access used by C++ call sites that don't pick one. Blueprint getters ignore it and are always checked, since a
+	// graph can't promise the type. Default means Checked here.
+	UPROPERTY(config, EditAnywhere, Category="BpVariant")
+	EBpVariantAccess DefaultAccess = EBpVariantAccess::Checked;
+
+	// How many keys a world's variant blackboard can hold. Its table is allocated up front so readers never wait on
+	// it growing.
+	UPROPERTY(config, EditAnywhere, Category="BpVariant")
+	int32 MaxBlackboardKeys = 1024;
+};
@@ -8,483 +8,599 @@
 #include <Kismet/KismetSystemLibrary.h>
 #include "StructUtils/InstancedStruct.h"
 #include "Misc/Optional.h"
+#include "Misc/TVariant.h"
 #include "ValueType.h"
+#include "BpVariantTypes_Generated.h"
+#include "BpValueBoxSettings.h"
 #include "BpVariant.generated.h"
 
+template <typename Type, typename TStorage>
+struct TBpVariantHasArm;
+
+/* Whether Type is stored directly in one of the arms of the given TVariant. */
+template <typename Type, typename... TArms>
+struct TBpVariantHasArm<Type, TVariant<TArms...>>
+{
+	static constexpr bool Value = (std::is_same_v<Type, TArms> || ...);
+};
+
+/*
+Everything known at compile time about storing Type in an FBpVariant: its arm and the EValueType it reports.
+Typed accessors go through this, so asking for a type FBpVariant can't hold fails to compile.
+*/
+template <typename Type>
+struct TBpVariantTraits
+{
+	static_assert(TBpVariantHasArm<Type, FBpVariantStorage>::Value,
+		"FBpVariant has no arm for this type. Wrap structs in an FInstancedStruct and other types in an FVariant.");
+
+	static constexpr SIZE_T ArmIndex = FBpVariantStorage::IndexOfType<Type>();
+	static constexpr EValueType ValueType = TBpVariantValueType<Type>::Value;
+};
+
+template <typename TStorage>
+struct TBpVariantArmTypes;
+
+/* The EValueType of every arm, indexed by the arm's index in the TVariant. */
+template <typename... TArms>
+struct TBpVariantArmTypes<TVariant<TArms...>>
+{
+	static constexpr EValueType Values[] = {TBpVariantValueType<TArms>::Value...};
+};
+
+/* Custom version for how FBpVariant is saved. */
+struct BPVALUEBOX_API FBpVariantCustomVersion
+{
+	enum Type
+	{
+		// Saved as tagged properties, which held nothing of the value since Data isn't a UPROPERTY
+		BeforeCustomVersionWasAdded = 0,
+		// A one byte type tag followed by a compact encoding of the value
+		CompactEncoding,
+
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+};
+
 /*
 This struct will simply hold a TVariant with all the base Blueprint types, nothing more.
 This will allow values to get passed around easily with value semantics instead of reference semantics.
-As of now, this holds 56 bytes in memory.
+It is only as big as its storage, which is the inline FTransform arm plus the index of the live arm.
 */
 USTRUCT(BlueprintType)
-struct FBpVariant
+struct BPVALUEBOX_API FBpVariant
 {
 	GENERATED_BODY()
 
-	TVariant<UObject*, UClass*, TSoftObjectPtr<UObject>, TSoftClassPtr<UObject>, FVariant, FText, FInstancedStruct>
-	Data;
-};
+	FBpVariantStorage Data;
 
-UCLASS()
-class BPVALUEBOX_API UBpVariantStatics : public UBlueprintFunctionLibrary
-{
-	GENERATED_BODY()
+	// Looked up from the live arm rather than stored, so it can't disagree with Data however Data was written
+	EValueType GetType() const { return TBpVariantArmTypes<FBpVariantStorage>::Values[Data.GetIndex()]; }
 
-public:
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static const bool Equals(const FBpVariant& Left, const FBpVariant& Right)
-	{
-		// If they don't have the same type, it's false
-		if (Left.Data.GetIndex() != Right.Data.GetIndex())
-		{
-			return false;
-		}
-		if (Left.Data.IsType<FVariant>() && Right.Data.IsType<FVariant>())
-		{
-			return Left.Data.Get<FVariant>() == Right.Data.Get<FVariant>();
-		}
-		if (Left.Data.IsType<FText>() && Right.Data.IsType<FText>())
-		{
-			return Left.Data.Get<FText>().EqualTo(Right.Data.Get<FText>());
-		}
-		if (Left.Data.IsType<FInstancedStruct>() && Right.Data.IsType<FInstancedStruct>())
-		{
-			return Left.Data.Get<FInstancedStruct>() == Right.Data.Get<FInstancedStruct>();
-		}
-		if (Left.Data.IsType<UObject*>() && Right.Data.IsType<UObject*>())
-		{
-			return Left.Data.Get<UObject*>() == Right.Data.Get<UObject*>();
-		}
-		return false;
-	}
+	// Same as UBpVariantStatics::Equals
+	bool operator==(const FBpVariant& Other) const;
+	bool operator!=(const FBpVariant& Other) const { return !(*this == Other); }
 
-	template <typename Type>
-	static FBpVariant SetValue(FBpVariant& Variant, Type Value)
-	{
-		Variant.Data.Set<Type>(Value);
-		return Variant;
-	}
+	// Consistent with operator==, so variants can key TMap and TSet
+	friend BPVALUEBOX_API uint32 GetTypeHash(const FBpVariant& Variant);
 
-	static FBpVariant SetVariant(FBpVariant& Variant, FVariant Value)
-	{
-		return SetValue(Variant, Value);
-	}
+	// Writes a one byte type tag followed by a compact encoding of the value.
+	// Returns false for packages saved before FBpVariantCustomVersion, so their tagged properties are read instead.
+	bool Serialize(FArchive& Ar);
 
-	static FBpVariant MakeFromFVariant(const FVariant& Value)
-	{
-		FBpVariant variant;
-		return SetValue(variant, Value);
-	}
+	// Same encoding as Serialize, with the quantization from UBpValueBoxSettings applied to vectors and rotators
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
 
-	template <typename T>
-	static FBpVariant MakeFromGeneric(const T& Value)
-	{
-		FBpVariant variant;
-		return SetValue(variant, Value);
-	}
+	// Reports the objects of the live arm to the GC, since Data is invisible to reflection
+	void AddStructReferencedObjects(FReferenceCollector& Collector);
+};
 
-	template <typename Type>
-	static Type GetValue(FBpVariant Variant)
-	{
-		if (Type* value = Variant.Data.TryGet<Type>())
-		{
-			return *value;
-		}
-		return Type();
-	}
+// Anything stored next to Data would be copied with every variant, see GetType
+static_assert(sizeof(FBpVariant) == sizeof(FBpVariantStorage), "FBpVariant should hold nothing but its storage");
 
-	// Add error checking on this using GetType
-	template <typename Type>
-	static Type GetVariant(FBpVariant Variant)
+template <>
+struct TStructOpsTypeTraits<FBpVariant> : public TStructOpsTypeTraitsBase2<FBpVariant>
+{
+	enum
 	{
-		FVariant variant = GetValue<FVariant>(Variant);
-		return variant.GetValue<Type>();
-	}
+		WithSerializer = true,
+		WithNetSerializer = true,
+		WithAddStructReferencedObjects = true,
+		WithIdenticalViaEquality = true,
+	};
+};
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static EValueType GetType(FBpVariant Variant)
-	{
-		if (Variant.Data.IsType<FVariant>())
-		{
-			FVariant value = Variant.Data.Get<FVariant>();
-			switch (value.GetType())
-			{
-			case EVariantTypes::Bool:
-				return EValueType::Bool;
-			case EVariantTypes::UInt8:
-				return EValueType::Byte;
-			case EVariantTypes::Int32:
-				return EValueType::Int32;
-			case EVariantTypes::Int64:
-				return EValueType::Int64;
-			case EVariantTypes::Float:
-				return EValueType::Float32;
-			case EVariantTypes::Double:
-				return EValueType::Float64;
-			case EVariantTypes::Name:
-				return EValueType::Name;
-			case EVariantTypes::String:
-				return EValueType::String;
-			case EVariantTypes::Vector:
-				return EValueType::Vector;
-			case EVariantTypes::Rotator:
-				return EValueType::Rotator;
-			case EVariantTypes::Transform:
-				return EValueType::Transform;
-			default: ;
-			}
-		}
-		if (Variant.Data.IsType<FText>())
-		{
-			return EValueType::Text;
-		}
-		if (Variant.Data.IsType<FInstancedStruct>())
-		{
-			return EValueType::Struct;
-		}
-		if (UObject** value = Variant.Data.TryGet<UObject*>())
-		{
-			if (value != nullptr)
-			{
-				return EValueType::Object;
-			}
-		}
-		return EValueType::None;
-	}
+/*
+A typed reference to the value of a variant, checked once when it is made. Reading through it afterwards is a plain
+dereference with no tag check. Use TBpVariantRef<const Type> for read only access to a const variant.
+The reference is invalidated by anything that changes the variant's type.
+*/
+template <typename Type>
+class TBpVariantRef
+{
+	using FValue = std::remove_const_t<Type>;
+	using FVariantType = std::conditional_t<std::is_const_v<Type>, const FBpVariant, FBpVariant>;
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetBool(UPARAM(ref)
-	                          FBpVariant& Variant, const bool Value)
+public:
+	explicit TBpVariantRef(FVariantType& InVariant)
+		: Value(InVariant.Data.GetIndex() == TBpVariantTraits<FValue>::ArmIndex
+			        ? &InVariant.Data.template Get<FValue>()
+			        : nullptr)
 	{
-		return SetVariant(Variant, Value);
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static bool GetBool(FBpVariant Variant)
-	{
-		return GetVariant<bool>(Variant);
-	}
+	bool IsValid() const { return Value != nullptr; }
+	explicit operator bool() const { return IsValid(); }
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromBool(const bool Value)
-	{
-		FBpVariant variant;
-		return SetVariant(variant, Value);
-	}
+	// nullptr if the variant held another type when the reference was made
+	Type* Get() const { return Value; }
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetByte(UPARAM(ref)
-	                          FBpVariant& Variant, const uint8 Value)
+	Type& operator*() const
 	{
-		return SetVariant(Variant, Value);
+		check(Value);
+		return *Get();
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static uint8 GetByte(FBpVariant Variant)
+	Type* operator->() const
 	{
-		return GetVariant<uint8>(Variant);
+		check(Value);
+		return Get();
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromByte(const uint8 Value)
-	{
-		FBpVariant variant;
-		return SetVariant(variant, Value);
-	}
+private:
+	Type* Value;
+};
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetInt(UPARAM(ref)
-	                         FBpVariant& Variant, const int32 Value)
-	{
-		return SetVariant(Variant, Value);
-	}
+/* How a value survives being converted to another type by UBpVariantStatics::ConvertTo. */
+UENUM(BlueprintType)
+enum class EBpVariantConversion : uint8
+{
+	// Every value converts and can be converted back, like Int32 to Float64 or Name to String
+	Lossless,
+	// Precision, range or identity can be lost, or the conversion can fail for some values, like parsing a String
+	Lossy,
+	// There is no conversion between the types
+	Rejected,
+};
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static int32 GetInt(FBpVariant Variant)
-	{
-		return GetVariant<int32>(Variant);
-	}
+/* Combines lambdas into one visitor, so UBpVariantStatics::Visit can be given a lambda per arm. */
+template <typename... TLambdas>
+struct TBpVariantOverloads : TLambdas...
+{
+	using TLambdas::operator()...;
+};
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromInt(const int32 Value)
-	{
-		FBpVariant variant;
-		return SetVariant(variant, Value);
-	}
+template <typename... TLambdas>
+TBpVariantOverloads(TLambdas...) -> TBpVariantOverloads<TLambdas...>;
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetInt64(UPARAM(ref)
-	                           FBpVariant& Variant, const int64 Value)
-	{
-		return SetVariant(Variant, Value);
-	}
+/*
+The part of the variant API that doesn't depend on the type. UBpVariantStatics in BpVariant_Generated.h adds the
+Set, Get and MakeVariantFrom functions for each type, so C++ and Blueprint should use that class.
+*/
+UCLASS(Abstract)
+class BPVALUEBOX_API UBpVariantStaticsBase : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
 
+public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static int64 GetInt64(FBpVariant Variant)
+	static const bool Equals(const FBpVariant& Left, const FBpVariant& Right)
 	{
-		return GetVariant<int64>(Variant);
+		// If they don't have the same type, it's false
+		if (Left.Data.GetIndex() != Right.Data.GetIndex())
+		{
+			return false;
+		}
+		return ::Visit([&Right](const auto& LeftValue)
+		{
+			using TValue = std::decay_t<decltype(LeftValue)>;
+			return AreValuesEqual(LeftValue, Right.Data.Get<TValue>());
+		}, Left.Data);
 	}
 
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromInt64(const int64 Value)
+	static int32 GetHash(const FBpVariant& Variant)
 	{
-		FBpVariant variant;
-		return SetVariant(variant, Value);
+		return static_cast<int32>(GetTypeHash(Variant));
 	}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetFloat(UPARAM(ref)
-	                           FBpVariant& Variant, const float Value)
+	// Returns a copy of the variant, which Blueprint setters need. C++ should use Assign instead.
+	template <typename Type>
+	static FBpVariant SetValue(FBpVariant& Variant, Type Value)
 	{
-		return SetVariant(Variant, Value);
+		return Assign(Variant, MoveTemp(Value));
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static float GetFloat(FBpVariant Variant)
+	// Copies or moves the value into the variant, without copying the variant back out
+	template <typename Type>
+	static FBpVariant& Assign(FBpVariant& Variant, Type&& Value)
 	{
-		return GetVariant<float>(Variant);
+		using TValue = std::decay_t<Type>;
+		Variant.Data.Set<TValue>(Forward<Type>(Value));
+		return Variant;
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromFloat(const float Value)
+	// Constructs the value in place from Args and returns it, so it can be filled in without another copy
+	template <typename Type, typename... TArgs>
+	static Type& Emplace(FBpVariant& Variant, TArgs&&... Args)
 	{
-		FBpVariant variant;
-		return SetVariant(variant, Value);
+		Variant.Data.Emplace<Type>(Forward<TArgs>(Args)...);
+		return Variant.Data.Get<Type>();
 	}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetDouble(UPARAM(ref)
-	                            FBpVariant& Variant, const double Value)
+	// Constructs a TStruct straight into the memory of the variant's FInstancedStruct
+	template <typename TStruct, typename... TArgs>
+	static TStruct& EmplaceStruct(FBpVariant& Variant, TArgs&&... Args)
 	{
-		return SetVariant(Variant, Value);
+		FInstancedStruct& value = Emplace<FInstancedStruct>(Variant);
+		value.InitializeAs<TStruct>(Forward<TArgs>(Args)...);
+		return value.GetMutable<TStruct>();
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static double GetDouble(FBpVariant Variant)
+	// Unpacks the FVariant into its native arm, only keeping the FVariant around when there is no native arm for it
+	static FBpVariant& SetVariant(FBpVariant& Variant, const FVariant& Value)
 	{
-		return GetVariant<double>(Variant);
+		switch (Value.GetType())
+		{
+		case EVariantTypes::Bool:
+			return Assign(Variant, Value.GetValue<bool>());
+		case EVariantTypes::UInt8:
+			return Assign(Variant, Value.GetValue<uint8>());
+		case EVariantTypes::Int32:
+			return Assign(Variant, Value.GetValue<int32>());
+		case EVariantTypes::Int64:
+			return Assign(Variant, Value.GetValue<int64>());
+		case EVariantTypes::Float:
+			return Assign(Variant, Value.GetValue<float>());
+		case EVariantTypes::Double:
+			return Assign(Variant, Value.GetValue<double>());
+		case EVariantTypes::Name:
+			return Assign(Variant, Value.GetValue<FName>());
+		case EVariantTypes::String:
+			return Assign(Variant, Value.GetValue<FString>());
+		case EVariantTypes::Vector:
+			return Assign(Variant, Value.GetValue<FVector>());
+		case EVariantTypes::Rotator:
+			return Assign(Variant, Value.GetValue<FRotator>());
+		case EVariantTypes::Transform:
+			return Assign(Variant, Value.GetValue<FTransform>());
+		default:
+			return Assign(Variant, Value);
+		}
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromDouble(const double Value)
+	static FBpVariant MakeFromFVariant(const FVariant& Value)
 	{
 		FBpVariant variant;
-		return SetVariant(variant, Value);
+		SetVariant(variant, Value);
+		return variant;
 	}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetName(UPARAM(ref)
-	                          FBpVariant& Variant, const FName& Value)
+	template <typename T>
+	static FBpVariant MakeFromGeneric(T&& Value)
 	{
-		return SetVariant(Variant, Value);
+		FBpVariant variant;
+		Assign(variant, Forward<T>(Value));
+		return variant;
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FName GetName(FBpVariant Variant)
+	// Makes a variant of every value, allocating OutVariants once
+	template <typename Type>
+	static void BoxArray(const TConstArrayView<Type> Values, TArray<FBpVariant>& OutVariants)
 	{
-		return GetVariant<FName>(Variant);
+		OutVariants.Reset(Values.Num());
+		for (const Type& value : Values)
+		{
+			Assign(OutVariants.AddDefaulted_GetRef(), value);
+		}
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromName(const FName& Value)
+	/*
+	Reads every variant as a Type, picking the access once for the whole array. Checked access gives mismatches a
+	default value and returns how many held a Type, unchecked access assumes they all do.
+	*/
+	template <typename Type, EBpVariantAccess Access = EBpVariantAccess::Default>
+	static int32 UnboxArray(const TConstArrayView<FBpVariant> Variants, TArray<Type>& OutValues)
 	{
-		FBpVariant variant;
-		return SetVariant(variant, Value);
-	}
+		OutValues.Reset(Variants.Num());
+		const EBpVariantAccess access = Access == EBpVariantAccess::Default ? GetDefaultAccess() : Access;
+		if (access == EBpVariantAccess::Unchecked)
+		{
+			for (const FBpVariant& variant : Variants)
+			{
+				OutValues.Add(GetUnchecked<Type>(variant));
+			}
+			return Variants.Num();
+		}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetString(UPARAM(ref)
-	                            FBpVariant& Variant, const FString& Value)
-	{
-		return SetVariant(Variant, Value);
+		int32 numHeld = 0;
+		for (const FBpVariant& variant : Variants)
+		{
+			if (const Type* value = TryGetValue<Type>(variant))
+			{
+				OutValues.Add(*value);
+				++numHeld;
+			}
+			else
+			{
+				ReportTypeMismatch(variant, TBpVariantTraits<Type>::ValueType);
+				OutValues.AddDefaulted();
+			}
+		}
+		return numHeld;
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FString GetString(FBpVariant Variant)
+	// Returns the value in place, or nullptr if the variant holds a different type. Never copies the payload.
+	template <typename Type>
+	static const Type* TryGetValue(const FBpVariant& Variant)
 	{
-		return GetVariant<FString>(Variant);
+		return TBpVariantRef<const Type>(Variant).Get();
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromString(const FString& Value)
+	template <typename Type>
+	static bool Holds(const FBpVariant& Variant)
 	{
-		return MakeFromFVariant(Value);
+		return Variant.Data.GetIndex() == TBpVariantTraits<Type>::ArmIndex;
 	}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetText(UPARAM(ref)
-	                          FBpVariant& Variant, const FText& Value)
+	// Calls Func with the value in place if the variant holds a Type, and returns whether it did
+	template <typename Type, typename TFunc>
+	static bool VisitAs(const FBpVariant& Variant, TFunc&& Func)
 	{
-		return SetValue(Variant, Value);
+		const TBpVariantRef<const Type> value(Variant);
+		if (value)
+		{
+			Invoke(Forward<TFunc>(Func), *value);
+		}
+		return value.IsValid();
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FText GetText(FBpVariant Variant)
+	template <typename Type>
+	static Type GetValue(const FBpVariant& Variant)
 	{
-		return GetValue<FText>(Variant);
+		if (const Type* value = TryGetValue<Type>(Variant))
+		{
+			return *value;
+		}
+		return Type();
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromText(const FText& Value)
+	/*
+	Calls Visitor with the value in place, through a table of one call per arm indexed by the live arm.
+	Visitor needs an overload for every arm, e.g. a generic lambda or TBpVariantOverloads ending in an auto catch all,
+	and all of them must return the same type.
+	*/
+	template <typename TVisitor>
+	static decltype(auto) Visit(const FBpVariant& Variant, TVisitor&& Visitor)
 	{
-		FBpVariant variant;
-		return SetValue(variant, Value);
+		return VisitArms(Variant, Visitor, static_cast<FBpVariantStorage*>(nullptr));
 	}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetVector(UPARAM(ref)
-	                            FBpVariant& Variant, const FVector& Value)
+	// Visitor may change the value, but not its type
+	template <typename TVisitor>
+	static decltype(auto) Visit(FBpVariant& Variant, TVisitor&& Visitor)
 	{
-		return SetVariant(Variant, Value);
+		return VisitArms(Variant, Visitor, static_cast<FBpVariantStorage*>(nullptr));
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FVector GetVector(const FBpVariant& Variant)
+	// Returns nothing if the variant holds another type, after logging it and counting it in GetNumTypeMismatches
+	template <typename Type>
+	static TOptional<Type> GetChecked(const FBpVariant& Variant)
 	{
-		return GetVariant<FVector>(Variant);
+		if (const Type* value = TryGetValue<Type>(Variant))
+		{
+			return *value;
+		}
+		ReportTypeMismatch(Variant, TBpVariantTraits<Type>::ValueType);
+		return {};
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromVector(const FVector& Value)
+	template <typename Type>
+	static bool TryGetChecked(const FBpVariant& Variant, Type& OutValue)
 	{
-		return MakeFromFVariant(Value);
+		if (const Type* value = TryGetValue<Type>(Variant))
+		{
+			OutValue = *value;
+			return true;
+		}
+		ReportTypeMismatch(Variant, TBpVariantTraits<Type>::ValueType);
+		return false;
 	}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetRotator(UPARAM(ref)
-	                             FBpVariant& Variant, const FRotator& Value)
+	// Only for call sites that know the variant holds a Type. See EBpVariantAccess::Unchecked.
+	template <typename Type>
+	static const Type& GetUnchecked(const FBpVariant& Variant)
 	{
-		return SetVariant(Variant, Value);
+		return Variant.Data.Get<Type>();
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FRotator GetRotator(const FBpVariant& Variant)
+	static EBpVariantAccess GetDefaultAccess()
 	{
-		return GetVariant<FRotator>(Variant);
+		const EBpVariantAccess access = GetDefault<UBpValueBoxSettings>()->DefaultAccess;
+		return access == EBpVariantAccess::Default ? EBpVariantAccess::Checked : access;
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromRotator(const FRotator& Value)
+	// Checked access returns a default value on a mismatch
+	template <typename Type, EBpVariantAccess Access = EBpVariantAccess::Default>
+	static Type GetAs(const FBpVariant& Variant)
 	{
-		return MakeFromFVariant(Value);
+		if constexpr (Access == EBpVariantAccess::Unchecked)
+		{
+			return GetUnchecked<Type>(Variant);
+		}
+		else if constexpr (Access == EBpVariantAccess::Checked)
+		{
+			Type value = Type();
+			TryGetChecked(Variant, value);
+			return value;
+		}
+		else
+		{
+			return GetDefaultAccess() == EBpVariantAccess::Unchecked
+				       ? GetAs<Type, EBpVariantAccess::Unchecked>(Variant)
+				       : GetAs<Type, EBpVariantAccess::Checked>(Variant);
+		}
 	}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetTransform(UPARAM(ref)
-	                               FBpVariant& Variant, const FTransform& Value)
+	// Number of checked reads that found another type since the module was loaded
+	static uint32 GetNumTypeMismatches();
+
+	// Returns a default value if the variant holds another type. Types with a native arm are read with Access.
+	template <typename Type, EBpVariantAccess Access = EBpVariantAccess::Default>
+	static Type GetVariant(const FBpVariant& Variant)
 	{
-		return SetVariant(Variant, Value);
+		if constexpr (TBpVariantHasArm<Type, FBpVariantStorage>::Value)
+		{
+			return GetAs<Type, Access>(Variant);
+		}
+		else
+		{
+			// Types without a native arm can only be stored through the FVariant interop arm.
+			// TVariantTraits fails to compile for types FVariant can't hold either.
+			if (const FVariant* value = TryGetValue<FVariant>(Variant))
+			{
+				if (value->GetType() == TVariantTraits<Type>::GetType())
+				{
+					return value->GetValue<Type>();
+				}
+			}
+			ReportTypeMismatch(Variant, EValueType::None);
+			return Type();
+		}
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FTransform GetTransform(const FBpVariant& Variant)
+	static const FString* TryGetString(const FBpVariant& Variant)
 	{
-		return GetVariant<FTransform>(Variant);
+		return TryGetValue<FString>(Variant);
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromTransform(const FTransform& Value)
+	// Views the string in place. The view is empty if the variant does not hold a string.
+	static FStringView GetStringView(const FBpVariant& Variant)
 	{
-		return MakeFromFVariant(Value);
+		if (const FString* value = TryGetString(Variant))
+		{
+			return *value;
+		}
+		return FStringView();
 	}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetStruct(UPARAM(ref)
-	                            FBpVariant& Variant, const FInstancedStruct& Value)
+	static const FText* TryGetText(const FBpVariant& Variant)
 	{
-		return SetValue(Variant, Value);
+		return TryGetValue<FText>(Variant);
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FInstancedStruct GetStruct(FBpVariant Variant)
+	static const FInstancedStruct* TryGetStruct(const FBpVariant& Variant)
 	{
-		return GetValue<FInstancedStruct>(Variant);
+		return TryGetValue<FInstancedStruct>(Variant);
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromStruct(const FInstancedStruct& Value)
+	// Views the struct in place when it is of type T, otherwise returns nullptr
+	template <typename T>
+	static const T* TryGetStructAs(const FBpVariant& Variant)
 	{
-		FBpVariant variant;
-		return SetValue(variant, Value);
+		if (const FInstancedStruct* value = TryGetStruct(Variant))
+		{
+			return value->GetPtr<T>();
+		}
+		return nullptr;
 	}
 
 	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetObject(UPARAM(ref)
-	                            FBpVariant& Variant, UObject* Value)
+	static EValueType GetType(const FBpVariant& Variant)
 	{
-		return SetValue(Variant, Value);
+		return Variant.GetType();
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static UObject* GetObject(const FBpVariant& Variant)
-	{
-		return *Variant.Data.TryGet<UObject*>();
-	}
+	// Looked up in a table built at compile time. Only None converts to None.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Conversion")
+	static EBpVariantConversion GetConversion(EValueType From, EValueType To);
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromObject(UObject* Value)
-	{
-		FBpVariant variant;
-		return SetValue(variant, Value);
-	}
+	/*
+	Converts the value to another type. Fails, leaving Result empty, when the conversion is rejected, when it is lossy
+	and bAllowLossy isn't set, or when a lossy conversion can't be done for this value, like parsing "abc" as an Int32.
+	Numbers saturate rather than wrap when they don't fit, and floats are truncated toward zero.
+	*/
+	UFUNCTION(BlueprintCallable, meta = ( ExpandBoolAsExecs = "ReturnValue" ), Category="BpVariant|Conversion")
+	static bool ConvertTo(const FBpVariant& Variant, EValueType Type, FBpVariant& Result,
+	                      EBpVariantConversion& Conversion, bool bAllowLossy = true);
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetClass(UPARAM(ref)
-	                           FBpVariant& Variant, UClass* Value)
-	{
-		return SetValue(Variant, Value);
-	}
+	// Converts every variant, leaving the ones that can't be converted empty. Returns how many were converted.
+	static int32 ConvertArray(TConstArrayView<FBpVariant> Variants, EValueType Type, TArrayView<FBpVariant> OutResults,
+	                          bool bAllowLossy = true);
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static UClass* GetClass(const FBpVariant& Variant)
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Conversion")
+	static int32 ConvertArrayTo(const TArray<FBpVariant>& Variants, EValueType Type, TArray<FBpVariant>& Results,
+	                            bool bAllowLossy = true)
 	{
-		return *Variant.Data.TryGet<UClass*>();
+		Results.SetNum(Variants.Num());
+		return ConvertArray(Variants, Type, Results, bAllowLossy);
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromClass(UClass* Value)
+	template <typename Type>
+	static TOptional<Type> TryConvert(const FBpVariant& Variant, const bool bAllowLossy = true)
 	{
-		FBpVariant variant;
-		return SetValue(variant, Value);
+		static_assert(TBpVariantTraits<Type>::ValueType != EValueType::None, "Only types with an EValueType convert");
+
+		FBpVariant result;
+		EBpVariantConversion conversion;
+		if (ConvertTo(Variant, TBpVariantTraits<Type>::ValueType, result, conversion, bAllowLossy))
+		{
+			return MoveTemp(*TBpVariantRef<Type>(result));
+		}
+		return {};
 	}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetSoftObject(UPARAM(ref)
-	                                FBpVariant& Variant, TSoftObjectPtr<UObject> Value)
+private:
+	static void ReportTypeMismatch(const FBpVariant& Variant, EValueType Expected);
+
+	template <typename TVariantType, typename TVisitor, typename... TArms>
+	static decltype(auto) VisitArms(TVariantType& Variant, TVisitor& Visitor, TVariant<TArms...>*)
 	{
-		return SetValue(Variant, Value);
+		using TData = std::conditional_t<std::is_const_v<TVariantType>, const FBpVariantStorage, FBpVariantStorage>;
+		using TResult = decltype(Visitor(DeclVal<TData&>().template Get<FEmptyVariantState>()));
+		using TArmCall = TResult(*)(TData&, TVisitor&);
+
+		static constexpr TArmCall ArmCalls[] =
+		{
+			[](TData& Data, TVisitor& InVisitor) -> TResult { return InVisitor(Data.template Get<TArms>()); }...
+		};
+		return ArmCalls[Variant.Data.GetIndex()](Variant.Data, Visitor);
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static TSoftObjectPtr<UObject> GetSoftObject(const FBpVariant& Variant)
+	template <typename Type>
+	static bool AreValuesEqual(const Type& Left, const Type& Right)
 	{
-		return *Variant.Data.TryGet<TSoftObjectPtr<UObject>>();
+		return Left == Right;
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromSoftObject(TSoftObjectPtr<UObject> Value)
+	static bool AreValuesEqual(const FEmptyVariantState&, const FEmptyVariantState&)
 	{
-		FBpVariant variant;
-		return SetValue(variant, Value);
+		return true;
 	}
 
-	UFUNCTION(BlueprintCallable, Category="BpVariant")
-	static FBpVariant SetSoftClass(UPARAM(ref)
-	                               FBpVariant& Variant, TSoftClassPtr<UObject> Value)
+	// FString's operator== ignores case, which FVariant's byte comparison never did
+	static bool AreValuesEqual(const FString& Left, const FString& Right)
 	{
-		return SetValue(Variant, Value);
+		return Left.Equals(Right, ESearchCase::CaseSensitive);
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static TSoftClassPtr<UObject> GetSoftClass(const FBpVariant& Variant)
+	// Compares the display strings exactly, like GetTypeHash, since FText::EqualTo depends on the culture
+	static bool AreValuesEqual(const FText& Left, const FText& Right)
 	{
-		return *Variant.Data.TryGet<TSoftClassPtr<UObject>>();
+		return Left.ToString().Equals(Right.ToString(), ESearchCase::CaseSensitive);
 	}
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant")
-	static FBpVariant MakeVariantFromSoftClass(TSoftClassPtr<UObject> Value)
+	static bool AreValuesEqual(const FTransform& Left, const FTransform& Right)
 	{
-		FBpVariant variant;
-		return SetValue(variant, Value);
+		return Left.GetRotation() == Right.GetRotation() && Left.GetTranslation() == Right.GetTranslation() &&
+			Left.GetScale3D() == Right.GetScale3D();
 	}
 };
+
+inline bool FBpVariant::operator==(const FBpVariant& Other) const
+{
+	return UBpVariantStaticsBase::Equals(*this, Other);
+}
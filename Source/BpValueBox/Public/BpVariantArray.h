@@ -0,0 +1,261 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "BpVariant.h"
+#include "ValueType.h"
+#include "BpVariantArray.generated.h"
+
+/* Where a string lives inside of FBpVariantArray's string arena. */
+struct FBpVariantStringSpan
+{
+	int32 Offset = 0;
+	int32 Length = 0;
+};
+
+/*
+An array of variants stored as a structure of arrays for bulk storage and fast scans.
+Every element has a one byte type tag. Its value lives in a dense column for its type, such as all of the int32s or all
+of the names, in the order the elements were added. Strings are packed into a single arena.
+Types that don't have a column of their own (text, transforms, structs and object references) are kept as FBpVariants.
+Adding and reading elements is O(1). Removing an element or changing its type is O(n) since the columns stay in order.
+*/
+USTRUCT(BlueprintType)
+struct BPVALUEBOX_API FBpVariantArray
+{
+	GENERATED_BODY()
+
+	int32 Num() const { return Tags.Num(); }
+	bool IsValidIndex(const int32 Index) const { return Tags.IsValidIndex(Index); }
+	EValueType GetType(const int32 Index) const { return Tags[Index]; }
+
+	int32 Add(const FBpVariant& Value);
+	FBpVariant Get(int32 Index) const;
+	void Set(int32 Index, const FBpVariant& Value);
+	void RemoveAt(int32 Index);
+	void Reset();
+	void Reserve(int32 Number);
+
+	// The tags of every element, one byte each, in element order
+	TConstArrayView<EValueType> GetTypes() const { return Tags; }
+
+	// Only reads the tags, none of the columns
+	void FindIndicesOfType(EValueType Type, TArray<int32>& OutIndices) const;
+	int32 CountOfType(EValueType Type) const;
+
+	// Each column holds the values of every element of that type, in element order
+	TConstArrayView<bool> GetBools() const { return Bools; }
+	TConstArrayView<uint8> GetBytes() const { return Bytes; }
+	TConstArrayView<int32> GetInt32s() const { return Int32s; }
+	TConstArrayView<int64> GetInt64s() const { return Int64s; }
+	TConstArrayView<float> GetFloat32s() const { return Float32s; }
+	TConstArrayView<double> GetFloat64s() const { return Float64s; }
+	TConstArrayView<FName> GetNames() const { return Names; }
+	TConstArrayView<FVector> GetVectors() const { return Vectors; }
+	TConstArrayView<FRotator> GetRotators() const { return Rotators; }
+
+	// Numeric columns can be changed in place, since any value is valid for them
+	TArrayView<uint8> GetMutableBytes() { return Bytes; }
+	TArrayView<int32> GetMutableInt32s() { return Int32s; }
+	TArrayView<int64> GetMutableInt64s() { return Int64s; }
+	TArrayView<float> GetMutableFloat32s() { return Float32s; }
+	TArrayView<double> GetMutableFloat64s() { return Float64s; }
+
+	// Views the string of a String element in place
+	FStringView GetStringView(int32 Index) const;
+
+	// Characters in the string arena, including the ones left behind by removed strings
+	int32 GetStringArenaNum() const { return StringArena.Num(); }
+
+	bool Serialize(FArchive& Ar);
+	void AddStructReferencedObjects(FReferenceCollector& Collector);
+	// Compares the elements, not the arena, so the characters left behind by removed strings don't count
+	bool Identical(const FBpVariantArray* Other, uint32 PortFlags) const;
+
+private:
+	enum class EColumn : uint8
+	{
+		Bools,
+		Bytes,
+		Int32s,
+		Int64s,
+		Float32s,
+		Float64s,
+		Names,
+		Strings,
+		Vectors,
+		Rotators,
+		Others,
+	};
+
+	static EColumn GetColumn(EValueType Type);
+	int32 GetColumnNum(EColumn Column) const;
+	void InsertIntoColumn(const FBpVariant& Value, int32 Slot);
+	void RemoveFromColumn(EValueType Type, int32 Slot);
+	void AssignInColumn(const FBpVariant& Value, int32 Slot);
+	int32 AppendToArena(FStringView Value);
+	// Repacks the arena once most of it is characters no string uses anymore
+	void CompactArenaIfNeeded();
+
+	// Number of elements before Index whose values are in Column
+	int32 CountInColumnBefore(EColumn Column, int32 Index) const;
+	// Moves the slots of the elements after Index whose values are in Column
+	void ShiftSlotsAfter(EColumn Column, int32 Index, int32 Delta);
+	// Returns false if the tags don't match the columns
+	bool RebuildSlots();
+
+	TArray<EValueType> Tags;
+	// Where each element's value is in its column
+	TArray<int32> Slots;
+
+	TArray<bool> Bools;
+	TArray<uint8> Bytes;
+	TArray<int32> Int32s;
+	TArray<int64> Int64s;
+	TArray<float> Float32s;
+	TArray<double> Float64s;
+	TArray<FName> Names;
+	TArray<FVector> Vectors;
+	TArray<FRotator> Rotators;
+	TArray<FBpVariantStringSpan> Strings;
+	// Removed and replaced strings leave unused characters behind until the arena is compacted
+	TArray<TCHAR> StringArena;
+	int32 NumUnusedChars = 0;
+	TArray<FBpVariant> Others;
+};
+
+template <>
+struct TStructOpsTypeTraits<FBpVariantArray> : public TStructOpsTypeTraitsBase2<FBpVariantArray>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithAddStructReferencedObjects = true,
+		WithIdentical = true,
+	};
+};
+
+UCLASS()
+class BPVALUEBOX_API UBpVariantArrayStatics : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Array")
+	static int32 AddVariant(UPARAM(ref) FBpVariantArray& Array, const FBpVariant& Value)
+	{
+		return Array.Add(Value);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static FBpVariant GetVariant(const FBpVariantArray& Array, const int32 Index)
+	{
+		return Array.IsValidIndex(Index) ? Array.Get(Index) : FBpVariant();
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Array")
+	static void SetVariant(UPARAM(ref) FBpVariantArray& Array, const int32 Index, const FBpVariant& Value)
+	{
+		if (Array.IsValidIndex(Index))
+		{
+			Array.Set(Index, Value);
+		}
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Array")
+	static void RemoveVariant(UPARAM(ref) FBpVariantArray& Array, const int32 Index)
+	{
+		if (Array.IsValidIndex(Index))
+		{
+			Array.RemoveAt(Index);
+		}
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static int32 Num(const FBpVariantArray& Array)
+	{
+		return Array.Num();
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static EValueType GetVariantType(const FBpVariantArray& Array, const int32 Index)
+	{
+		return Array.IsValidIndex(Index) ? Array.GetType(Index) : EValueType::None;
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<int32> FindIndicesOfType(const FBpVariantArray& Array, const EValueType Type)
+	{
+		TArray<int32> indices;
+		Array.FindIndicesOfType(Type, indices);
+		return indices;
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<bool> GetBools(const FBpVariantArray& Array)
+	{
+		return TArray<bool>(Array.GetBools());
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<uint8> GetBytes(const FBpVariantArray& Array)
+	{
+		return TArray<uint8>(Array.GetBytes());
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<int32> GetInts(const FBpVariantArray& Array)
+	{
+		return TArray<int32>(Array.GetInt32s());
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<int64> GetInt64s(const FBpVariantArray& Array)
+	{
+		return TArray<int64>(Array.GetInt64s());
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<float> GetFloats(const FBpVariantArray& Array)
+	{
+		return TArray<float>(Array.GetFloat32s());
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<double> GetDoubles(const FBpVariantArray& Array)
+	{
+		return TArray<double>(Array.GetFloat64s());
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<FName> GetNames(const FBpVariantArray& Array)
+	{
+		return TArray<FName>(Array.GetNames());
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<FVector> GetVectors(const FBpVariantArray& Array)
+	{
+		return TArray<FVector>(Array.GetVectors());
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<FRotator> GetRotators(const FBpVariantArray& Array)
+	{
+		return TArray<FRotator>(Array.GetRotators());
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Array")
+	static TArray<FString> GetStrings(const FBpVariantArray& Array)
+	{
+		TArray<FString> strings;
+		for (int32 i = 0; i < Array.Num(); ++i)
+		{
+			if (Array.GetType(i) == EValueType::String)
+			{
+				strings.Emplace(Array.GetStringView(i));
+			}
+		}
+		return strings;
+	}
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BpVariant.h"
+#include "BpVariantBlackboard.generated.h"
+
+/*
+Variants keyed by name that any thread can read and write without taking a lock.
+Each key's value is an immutable snapshot that writers replace with a single pointer swap, so a reader always sees a
+whole value and never waits on a writer of an existing key. Replaced snapshots are freed on the game thread once no
+reader from before the swap can still be using them.
+The cost is on the write side: every write allocates a new snapshot and queues up to two TQueue nodes, rather than
+storing the variant in its slot. The one wait is while a key is being added, since its slot is claimed before its name
+is written. A reader whose probe passes that slot yields until the name is in, so it can be held up by a preempted
+writer adding a new key.
+Keys are never removed, and the table is allocated up front with room for MaxBlackboardKeys from UBpValueBoxSettings.
+Values holding objects or structs can only be written from the game thread, since the GC only runs there.
+*/
+class BPVALUEBOX_API FBpVariantBlackboard
+{
+public:
+	explicit FBpVariantBlackboard(int32 InMaxKeys);
+	~FBpVariantBlackboard();
+
+	FBpVariantBlackboard(const FBpVariantBlackboard&) = delete;
+	FBpVariantBlackboard& operator=(const FBpVariantBlackboard&) = delete;
+
+	// Fails and logs when the key is None, the blackboard is full or an object is written off the game thread
+	bool SetValue(FName Key, FBpVariant Value);
+
+	template <typename Type>
+	bool Set(const FName Key, Type&& Value)
+	{
+		return SetValue(Key, UBpVariantStaticsBase::MakeFromGeneric(Forward<Type>(Value)));
+	}
+
+	// Copies out the latest value of the key. OutVersion is the version it was written with.
+	bool TryGetValue(FName Key, FBpVariant& OutValue, uint64* OutVersion = nullptr) const;
+
+	// Returns nothing if the key has no value or holds another type
+	template <typename Type>
+	TOptional<Type> Get(const FName Key) const
+	{
+		TOptional<Type> result;
+		Read(Key, [&result](const FBpVariant& Value)
+		{
+			if (const Type* value = UBpVariantStaticsBase::TryGetValue<Type>(Value))
+			{
+				result = *value;
+			}
+		});
+		return result;
+	}
+
+	// Calls Func with the latest value in place, without copying it. Func must not hold on to the value.
+	template <typename TFunc>
+	bool Read(const FName Key, TFunc&& Func) const
+	{
+		const FReadScope scope(*this);
+		if (const FValue* value = FindValue(Key))
+		{
+			Invoke(Forward<TFunc>(Func), value->Variant);
+			return true;
+		}
+		return false;
+	}
+
+	// Version of the key's latest write. One counter numbers the writes to every key, and 0 means it was never written.
+	uint64 GetVersion(FName Key) const;
+
+	TArray<FName> GetKeys() const;
+
+	/*
+	Game thread only. Frees the snapshots no reader can still see and fills OutChangedKeys with every key written since
+	the last flush, once each no matter how often it was written.
+	*/
+	void Flush(TArray<FName>& OutChangedKeys);
+
+	// Game thread only, for the owner's AddReferencedObjects
+	void AddReferencedObjects(FReferenceCollector& Collector);
+
+private:
+	struct FValue
+	{
+		FBpVariant Variant;
+		uint64 Version = 0;
+	};
+
+	struct FSlot
+	{
+		// Packed FName, see PackKey. Empty until the slot is claimed, Claiming while Name is being written.
+		std::atomic<uint64> Key = 0;
+		FName Name;
+		std::atomic<FValue*> Value = nullptr;
+		// Set by the first write since the last flush, so each key is only queued once
+		std::atomic<bool> bChanged = false;
+	};
+
+	/*
+	Counts a reader in the current epoch for as long as it is alive. Flushing flips the epoch and only frees the
+	snapshots replaced before the flip once the readers of the previous epoch are gone.
+	*/
+	class FReadScope
+	{
+	public:
+		explicit FReadScope(const FBpVariantBlackboard& InBlackboard);
+		~FReadScope();
+
+	private:
+		const FBpVariantBlackboard& Blackboard;
+		uint32 Epoch;
+	};
+
+	static uint64 PackKey(FName Key);
+
+	FSlot* FindSlot(FName Key) const;
+	FSlot* FindOrAddSlot(FName Key);
+	const FValue* FindValue(FName Key) const;
+
+	void ReclaimValues();
+
+	TUniquePtr<FSlot[]> Slots;
+	uint32 NumSlots = 0;
+	std::atomic<int32> NumKeys = 0;
+	int32 MaxKeys = 0;
+
+	std::atomic<uint64> LastVersion = 0;
+
+	mutable std::atomic<uint32> Epoch = 0;
+	mutable std::atomic<int32> NumReaders[2] = {0, 0};
+
+	// Replaced by writers, waiting for the next flush
+	TQueue<FValue*, EQueueMode::Mpsc> ReplacedValues;
+	// Taken from ReplacedValues by the last flush, waiting for the readers of the previous epoch to leave
+	TArray<FValue*> RetiredValues;
+
+	TQueue<FSlot*, EQueueMode::Mpsc> ChangedSlots;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnBpVariantBlackboardChanged, const TArray<FName>&);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBpVariantBlackboardChangedDynamic, const TArray<FName>&, Keys);
+
+/*
+Gives each world an FBpVariantBlackboard. Async tasks should take the blackboard from GetBlackboard and write to it
+directly, which keeps it alive even if the world goes away first. The keys changed during a frame are announced once,
+on the game thread after the actor tick.
+*/
+UCLASS()
+class BPVALUEBOX_API UBpVariantBlackboardSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UBpVariantBlackboardSubsystem* Get(const UObject* Context);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+	TSharedRef<FBpVariantBlackboard, ESPMode::ThreadSafe> GetBlackboard() const { return Blackboard.ToSharedRef(); }
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Blackboard")
+	bool SetBlackboardValue(const FName Key, const FBpVariant& Value);
+
+	UFUNCTION(BlueprintCallable, meta = ( ExpandBoolAsExecs = "ReturnValue" ), Category="BpVariant|Blackboard")
+	bool GetBlackboardValue(const FName Key, FBpVariant& Value) const;
+
+	// Sends every key changed since the last announcement now, instead of waiting for the end of the actor tick
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Blackboard")
+	void FlushChanges();
+
+	FOnBpVariantBlackboardChanged OnKeysChanged;
+
+	UPROPERTY(BlueprintAssignable, Category="BpVariant|Blackboard")
+	FOnBpVariantBlackboardChangedDynamic OnBlackboardKeysChanged;
+
+private:
+	void HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	TSharedPtr<FBpVariantBlackboard, ESPMode::ThreadSafe> Blackboard;
+
+	FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "BpVariant.h"
+#include "BpVariantArray.h"
+#include "BpVariantKernels.generated.h"
+
+UENUM(BlueprintType)
+enum class EBpVariantComparison : uint8
+{
+	Less,
+	LessOrEqual,
+	Equal,
+	NotEqual,
+	Greater,
+	GreaterOrEqual,
+};
+
+/*
+Batch math over many numbers at once, four at a time with SIMD.
+Packed columns (arrays of floats or doubles, or the columns of FBpVariantArray) go straight to the SIMD loops.
+Arrays of variants are read into small batches of doubles first, with a tight loop for each run of the same type, then
+go through the same SIMD loops. Byte, Int32, Int64, Float32 and Float64 variants count as numbers.
+*/
+struct BPVALUEBOX_API FBpVariantKernels
+{
+	static double Sum(TConstArrayView<double> Values);
+	// Adds in single precision, use doubles when the total needs more than about seven digits
+	static double Sum(TConstArrayView<float> Values);
+	// Returns false if there are no values
+	static bool MinMax(TConstArrayView<double> Values, double& OutMin, double& OutMax);
+	static bool MinMax(TConstArrayView<float> Values, float& OutMin, float& OutMax);
+	static void Scale(TArrayView<double> Values, double Factor);
+	static void Scale(TArrayView<float> Values, float Factor);
+	// OutValues must be as long as A and B
+	static void Lerp(TConstArrayView<double> A, TConstArrayView<double> B, double Alpha, TArrayView<double> OutValues);
+	static void CompareToScalar(TConstArrayView<double> Values, double Scalar, EBpVariantComparison Comparison,
+	                            TArray<bool>& OutResults);
+
+	// Skips variants that aren't numbers
+	static double Sum(TConstArrayView<FBpVariant> Values);
+	static bool MinMax(TConstArrayView<FBpVariant> Values, double& OutMin, double& OutMax);
+	// Each variant keeps its type, integers are rounded and clamped to their range
+	static void Scale(TArrayView<FBpVariant> Values, double Factor);
+	// Variants that aren't numbers are read as zero
+	static void Lerp(TConstArrayView<FBpVariant> A, TConstArrayView<FBpVariant> B, double Alpha,
+	                 TArray<double>& OutValues);
+	// Variants that aren't numbers never pass the comparison
+	static void CompareToScalar(TConstArrayView<FBpVariant> Values, double Scalar, EBpVariantComparison Comparison,
+	                            TArray<bool>& OutResults);
+
+	// Works on the numeric columns of the array
+	static double Sum(const FBpVariantArray& Values);
+	static bool MinMax(const FBpVariantArray& Values, double& OutMin, double& OutMax);
+	static void Scale(FBpVariantArray& Values, double Factor);
+};
+
+UCLASS()
+class BPVALUEBOX_API UBpVariantKernelStatics : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Math")
+	static double SumVariants(const TArray<FBpVariant>& Values)
+	{
+		return FBpVariantKernels::Sum(TConstArrayView<FBpVariant>(Values));
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Math")
+	static bool MinMaxVariants(const TArray<FBpVariant>& Values, double& Min, double& Max)
+	{
+		return FBpVariantKernels::MinMax(TConstArrayView<FBpVariant>(Values), Min, Max);
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Math")
+	static void ScaleVariants(UPARAM(ref) TArray<FBpVariant>& Values, const double Factor)
+	{
+		FBpVariantKernels::Scale(TArrayView<FBpVariant>(Values), Factor);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Math")
+	static TArray<double> LerpVariants(const TArray<FBpVariant>& A, const TArray<FBpVariant>& B, const double Alpha)
+	{
+		TArray<double> values;
+		FBpVariantKernels::Lerp(A, B, Alpha, values);
+		return values;
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Math")
+	static TArray<bool> CompareVariantsToScalar(const TArray<FBpVariant>& Values, const double Scalar,
+	                                            const EBpVariantComparison Comparison)
+	{
+		TArray<bool> results;
+		FBpVariantKernels::CompareToScalar(TConstArrayView<FBpVariant>(Values), Scalar, Comparison, results);
+		return results;
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Math")
+	static double SumVariantArray(const FBpVariantArray& Values)
+	{
+		return FBpVariantKernels::Sum(Values);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Math")
+	static bool MinMaxVariantArray(const FBpVariantArray& Values, double& Min, double& Max)
+	{
+		return FBpVariantKernels::MinMax(Values, Min, Max);
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Math")
+	static void ScaleVariantArray(UPARAM(ref) FBpVariantArray& Values, const double Factor)
+	{
+		FBpVariantKernels::Scale(Values, Factor);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Math")
+	static double SumDoubles(const TArray<double>& Values)
+	{
+		return FBpVariantKernels::Sum(TConstArrayView<double>(Values));
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Math")
+	static bool MinMaxDoubles(const TArray<double>& Values, double& Min, double& Max)
+	{
+		return FBpVariantKernels::MinMax(TConstArrayView<double>(Values), Min, Max);
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Math")
+	static void ScaleDoubles(UPARAM(ref) TArray<double>& Values, const double Factor)
+	{
+		FBpVariantKernels::Scale(TArrayView<double>(Values), Factor);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Math")
+	static TArray<double> LerpDoubles(const TArray<double>& A, const TArray<double>& B, const double Alpha)
+	{
+		TArray<double> values;
+		values.SetNumUninitialized(FMath::Min(A.Num(), B.Num()));
+		FBpVariantKernels::Lerp(MakeArrayView(A.GetData(), values.Num()), MakeArrayView(B.GetData(), values.Num()),
+		                        Alpha, values);
+		return values;
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Math")
+	static TArray<bool> CompareDoublesToScalar(const TArray<double>& Values, const double Scalar,
+	                                           const EBpVariantComparison Comparison)
+	{
+		TArray<bool> results;
+		FBpVariantKernels::CompareToScalar(TConstArrayView<double>(Values), Scalar, Comparison, results);
+		return results;
+	}
+};
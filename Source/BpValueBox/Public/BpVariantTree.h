@@ -0,0 +1,339 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "BpVariant.h"
+#include "BpVariantTree.generated.h"
+
+UENUM(BlueprintType)
+enum class EBpVariantNodeKind : uint8
+{
+	Value,
+	Object,
+	List,
+};
+
+/* One step of a path, either a key into an object or an index into a list. */
+struct FBpVariantPathSegment
+{
+	FName Key;
+	int32 Index = INDEX_NONE;
+
+	bool IsIndex() const { return Index != INDEX_NONE; }
+};
+
+/*
+A path into a variant tree such as "a.b[3].c", parsed once so lookups don't have to.
+An empty path is the root. Only the path string is saved, and it is parsed again on load and text import.
+*/
+USTRUCT(BlueprintType)
+struct BPVALUEBOX_API FBpVariantPath
+{
+	GENERATED_BODY()
+
+	FBpVariantPath() = default;
+	explicit FBpVariantPath(FStringView Path);
+
+	bool IsValid() const { return bValid; }
+	TConstArrayView<FBpVariantPathSegment> GetSegments() const { return Segments; }
+	const FString& ToString() const { return Source; }
+
+	void PostSerialize(const FArchive& Ar);
+	bool ExportTextItem(FString& ValueStr, const FBpVariantPath& DefaultValue, UObject* Parent, int32 PortFlags,
+	                    UObject* ExportRootScope) const;
+	bool ImportTextItem(const TCHAR*& Buffer, int32 PortFlags, UObject* Parent, FOutputDevice* ErrorText);
+
+private:
+	void Parse();
+
+	UPROPERTY(VisibleAnywhere, Category="BpVariant")
+	FString Source;
+
+	TArray<FBpVariantPathSegment, TInlineAllocator<4>> Segments;
+	bool bValid = true;
+};
+
+template <>
+struct TStructOpsTypeTraits<FBpVariantPath> : public TStructOpsTypeTraitsBase2<FBpVariantPath>
+{
+	enum
+	{
+		WithPostSerialize = true,
+		WithExportTextItem = true,
+		WithImportTextItem = true,
+	};
+};
+
+/*
+A tree of variants, like a JavaScript object. Nodes are values, objects keyed by FName or lists.
+Every node lives in a few arrays shared by the whole tree, so adding nodes doesn't allocate once they have grown.
+Objects are open addressing tables and lists are runs of node indices, both carved out of the shared arrays.
+Nodes are referred to by index, which stays valid until the node is removed or the tree is compacted.
+Removed nodes and outgrown tables are left behind until Compact is called.
+*/
+USTRUCT(BlueprintType)
+struct BPVALUEBOX_API FBpVariantTree
+{
+	GENERATED_BODY()
+
+	static constexpr int32 Root = 0;
+
+	FBpVariantTree() : FBpVariantTree(EBpVariantNodeKind::Object)
+	{
+	}
+
+	explicit FBpVariantTree(EBpVariantNodeKind RootKind);
+
+	bool IsValidNode(const int32 Node) const { return Nodes.IsValidIndex(Node); }
+	EBpVariantNodeKind GetKind(const int32 Node) const { return Nodes[Node].Kind; }
+	// Number of children of an object or list
+	int32 Num(const int32 Node) const { return Nodes[Node].Kind == EBpVariantNodeKind::Value ? 0 : Nodes[Node].Num; }
+	// Includes removed nodes that haven't been compacted away
+	int32 GetNumNodes() const { return Nodes.Num(); }
+
+	// Returns nullptr if the node isn't a value
+	const FBpVariant* TryGetValue(int32 Node) const;
+	bool SetValue(int32 Node, const FBpVariant& Value);
+
+	int32 FindChild(int32 Object, FName Key) const;
+	// Returns the existing child, replacing it first if bReplace is set and it is of another kind
+	int32 FindOrAddChild(int32 Object, FName Key, EBpVariantNodeKind Kind, bool bReplace = true);
+	bool RemoveChild(int32 Object, FName Key);
+	void GetKeys(int32 Object, TArray<FName>& OutKeys) const;
+
+	int32 GetItem(int32 List, int32 Index) const;
+	int32 AddItem(int32 List, EBpVariantNodeKind Kind);
+	// Index can be one past the end to add an item
+	int32 FindOrAddItem(int32 List, int32 Index, EBpVariantNodeKind Kind, bool bReplace = true);
+	bool RemoveItem(int32 List, int32 Index);
+
+	// Returns INDEX_NONE if any step of the path is missing
+	int32 Find(const FBpVariantPath& Path) const;
+	// Adds missing objects and lists along the way. Only the last step replaces a node of another kind.
+	int32 FindOrAdd(const FBpVariantPath& Path, EBpVariantNodeKind Kind);
+	bool Remove(const FBpVariantPath& Path);
+
+	void Reset();
+	// Copies the live nodes into fresh arrays, which changes node indices
+	void Compact();
+
+	bool Serialize(FArchive& Ar);
+	void AddStructReferencedObjects(FReferenceCollector& Collector);
+	// Compares what is reachable from the root, so removed nodes and the layout of the arrays don't count
+	bool Identical(const FBpVariantTree* Other, uint32 PortFlags) const;
+
+protected:
+	struct FNode
+	{
+		EBpVariantNodeKind Kind = EBpVariantNodeKind::Value;
+		// Values: index into Values. Objects: first slot in Slots. Lists: first index in Items.
+		int32 Offset = 0;
+		int32 Capacity = 0;
+		int32 Num = 0;
+		// Objects only, slots that are in use or were removed
+		int32 Used = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FNode& Node)
+		{
+			return Ar << Node.Kind << Node.Offset << Node.Capacity << Node.Num << Node.Used;
+		}
+	};
+
+	struct FSlot
+	{
+		FName Key;
+		int32 Node = INDEX_NONE;
+
+		friend FArchive& operator<<(FArchive& Ar, FSlot& Slot)
+		{
+			return Ar << Slot.Key << Slot.Node;
+		}
+	};
+
+	int32 AddNode(EBpVariantNodeKind Kind);
+	int32 FindSlot(int32 Object, FName Key) const;
+	void InsertSlot(int32 Object, FName Key, int32 Child);
+	void GrowSlots(int32 Object, int32 Capacity);
+	void GrowItems(int32 List);
+	int32 CopyNode(const FBpVariantTree& Source, int32 SourceNode);
+	bool IsValidStorage() const;
+
+	TArray<FNode> Nodes;
+	TArray<FBpVariant> Values;
+	TArray<FSlot> Slots;
+	TArray<int32> Items;
+};
+
+template <>
+struct TStructOpsTypeTraits<FBpVariantTree> : public TStructOpsTypeTraitsBase2<FBpVariantTree>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithAddStructReferencedObjects = true,
+		WithIdentical = true,
+	};
+};
+
+/* A variant tree whose root is an object. */
+USTRUCT(BlueprintType)
+struct BPVALUEBOX_API FBpVariantObject : public FBpVariantTree
+{
+	GENERATED_BODY()
+
+	FBpVariantObject() : FBpVariantTree(EBpVariantNodeKind::Object)
+	{
+	}
+};
+
+template <>
+struct TStructOpsTypeTraits<FBpVariantObject> : public TStructOpsTypeTraitsBase2<FBpVariantObject>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithAddStructReferencedObjects = true,
+		WithIdentical = true,
+	};
+};
+
+/* A variant tree whose root is a list. Paths into it start with an index, like "[0].a". */
+USTRUCT(BlueprintType)
+struct BPVALUEBOX_API FBpVariantList : public FBpVariantTree
+{
+	GENERATED_BODY()
+
+	FBpVariantList() : FBpVariantTree(EBpVariantNodeKind::List)
+	{
+	}
+};
+
+template <>
+struct TStructOpsTypeTraits<FBpVariantList> : public TStructOpsTypeTraitsBase2<FBpVariantList>
+{
+	enum
+	{
+		WithSerializer = true,
+		WithAddStructReferencedObjects = true,
+		WithIdentical = true,
+	};
+};
+
+UCLASS()
+class BPVALUEBOX_API UBpVariantTreeStatics : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Tree")
+	static FBpVariantPath MakeVariantPath(const FString& Path)
+	{
+		return FBpVariantPath(Path);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Tree")
+	static bool IsValidPath(const FBpVariantPath& Path)
+	{
+		return Path.IsValid();
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Tree")
+	static bool GetValueAtPath(const FBpVariantObject& Object, const FBpVariantPath& Path, FBpVariant& Value)
+	{
+		return GetValue(Object, Path, Value);
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Tree")
+	static bool SetValueAtPath(UPARAM(ref) FBpVariantObject& Object, const FBpVariantPath& Path,
+	                           const FBpVariant& Value)
+	{
+		return Object.SetValue(Object.FindOrAdd(Path, EBpVariantNodeKind::Value), Value);
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Tree")
+	static bool AddValueToListAtPath(UPARAM(ref) FBpVariantObject& Object, const FBpVariantPath& Path,
+	                                 const FBpVariant& Value)
+	{
+		return AddValue(Object, Path, Value);
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Tree")
+	static bool RemoveAtPath(UPARAM(ref) FBpVariantObject& Object, const FBpVariantPath& Path)
+	{
+		return Object.Remove(Path);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Tree")
+	static bool GetKindAtPath(const FBpVariantObject& Object, const FBpVariantPath& Path, EBpVariantNodeKind& Kind)
+	{
+		const int32 node = Object.Find(Path);
+		Kind = node != INDEX_NONE ? Object.GetKind(node) : EBpVariantNodeKind::Value;
+		return node != INDEX_NONE;
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Tree")
+	static TArray<FName> GetKeysAtPath(const FBpVariantObject& Object, const FBpVariantPath& Path)
+	{
+		TArray<FName> keys;
+		const int32 node = Object.Find(Path);
+		if (node != INDEX_NONE)
+		{
+			Object.GetKeys(node, keys);
+		}
+		return keys;
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Tree")
+	static int32 NumAtPath(const FBpVariantObject& Object, const FBpVariantPath& Path)
+	{
+		const int32 node = Object.Find(Path);
+		return node != INDEX_NONE ? Object.Num(node) : 0;
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Tree")
+	static bool GetListValueAtPath(const FBpVariantList& List, const FBpVariantPath& Path, FBpVariant& Value)
+	{
+		return GetValue(List, Path, Value);
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Tree")
+	static bool SetListValueAtPath(UPARAM(ref) FBpVariantList& List, const FBpVariantPath& Path,
+	                               const FBpVariant& Value)
+	{
+		return List.SetValue(List.FindOrAdd(Path, EBpVariantNodeKind::Value), Value);
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Tree")
+	static bool AddValueToList(UPARAM(ref) FBpVariantList& List, const FBpVariant& Value)
+	{
+		return AddValue(List, FBpVariantPath(), Value);
+	}
+
+	UFUNCTION(BlueprintCallable, Category="BpVariant|Tree")
+	static bool RemoveAtListPath(UPARAM(ref) FBpVariantList& List, const FBpVariantPath& Path)
+	{
+		return List.Remove(Path);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="BpVariant|Tree")
+	static int32 NumAtListPath(const FBpVariantList& List, const FBpVariantPath& Path)
+	{
+		const int32 node = List.Find(Path);
+		return node != INDEX_NONE ? List.Num(node) : 0;
+	}
+
+private:
+	static bool GetValue(const FBpVariantTree& Tree, const FBpVariantPath& Path, FBpVariant& OutValue)
+	{
+		const int32 node = Tree.Find(Path);
+		const FBpVariant* value = node != INDEX_NONE ? Tree.TryGetValue(node) : nullptr;
+		OutValue = value != nullptr ? *value : FBpVariant();
+		return value != nullptr;
+	}
+
+	static bool AddValue(FBpVariantTree& Tree, const FBpVariantPath& Path, const FBpVariant& Value)
+	{
+		const int32 list = Tree.FindOrAdd(Path, EBpVariantNodeKind::List);
+		return list != INDEX_NONE && Tree.SetValue(Tree.AddItem(list, EBpVariantNodeKind::Value), Value);
+	}
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BpVariant.h"
+#include "ValueType.h"
+
+/*
+The type tags of every element of a tuple, packed one byte per element into 64 bit words.
+Checking a whole tuple's types is one compare for every eight elements.
+The FBpVariantTuple2 through FBpVariantTuple16 structs that use this are generated by BpValueBox.Build.cs.
+*/
+template <int32 N>
+struct TBpVariantTupleSignature
+{
+	static constexpr int32 NumWords = (N + 7) / 8;
+
+	// Every byte is EValueType::None, including the ones past the last element
+	static constexpr uint64 EmptyWord = 0x0101010101010101ull * static_cast<uint8>(EValueType::None);
+
+	uint64 Words[NumWords];
+
+	TBpVariantTupleSignature()
+	{
+		for (uint64& word : Words)
+		{
+			word = EmptyWord;
+		}
+	}
+
+	EValueType Get(const int32 Index) const
+	{
+		check(Index >= 0 && Index < N);
+		return static_cast<EValueType>(Words[Index / 8] >> (Index % 8 * 8) & 0xFF);
+	}
+
+	void Set(const int32 Index, const EValueType Type)
+	{
+		check(Index >= 0 && Index < N);
+		const int32 shift = Index % 8 * 8;
+		Words[Index / 8] = (Words[Index / 8] & ~(0xFFull << shift)) | static_cast<uint64>(Type) << shift;
+	}
+
+	// The signature a tuple holding these C++ types in order would have
+	template <typename... Types>
+	static TBpVariantTupleSignature Make()
+	{
+		static_assert(sizeof...(Types) == N, "A type is needed for every element of the tuple");
+		TBpVariantTupleSignature signature;
+		int32 index = 0;
+		(signature.Set(index++, TBpVariantValueType<Types>::Value), ...);
+		return signature;
+	}
+
+	bool operator==(const TBpVariantTupleSignature& Other) const
+	{
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			if (Words[i] != Other.Words[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool operator!=(const TBpVariantTupleSignature& Other) const
+	{
+		return !(*this == Other);
+	}
+};
@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "ValueType.generated.h"
 
+// New types go at the end of EValueType, after None, since saved variants store it
 UENUM(BlueprintType)
 enum class EValueType : uint8
 {
@@ -20,6 +21,8 @@ enum class EValueType : uint8
 	Transform,
 	Struct,
 	Object,
+	Class,
+	SoftObject,
+	SoftClass,
 	None,
-	// May need to add a UObjectSoftPointer, UClass, and UClassSoftPointer
 };
@@ -1,6 +1,9 @@
 ﻿#include "Misc/AutomationTest.h"
 #include "BoxedValue.h"
 #include "BoxedValue_Generated.h"
+#include "BoxedValuePool.h"
+#include "Engine/World.h"
+#include "Tasks/Task.h"
 #include "TestObject.h"
 #include "ValueType.h"
 
@@ -16,12 +19,14 @@ bool TestBoxedValue(FAutomationTestBase* Context, const TInputType& Input, const
 	const EValueType boxType = IBoxedType::Execute_GetType(value.GetObject());
 
 	const bool typeCorrect = boxType == ExpectedType;
+	const bool nativeTypeCorrect = UBoxedValueStatics::GetBoxType(value) == ExpectedType;
 	const bool valueCorrect = actual == Input;
 
 	Context->TestTrue(TEXT("BoxedValue type should be expected type"), typeCorrect);
+	Context->TestTrue(TEXT("BoxedValue native type should be expected type"), nativeTypeCorrect);
 	Context->TestTrue(TEXT("BoxedValue value should match the original value"), valueCorrect);
 
-	return typeCorrect && valueCorrect;
+	return typeCorrect && nativeTypeCorrect && valueCorrect;
 }
 
 bool TestBoxedText(FAutomationTestBase* Context, const FText& Input)
@@ -123,6 +128,193 @@ bool TestBoxCanBeChanged(FAutomationTestBase* Context)
 		copyValueCorrect;
 }
 
+bool TestBoxesAreRecycled(FAutomationTestBase* Context)
+{
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false);
+
+	UBoxedInt32* first = UBoxedInt32::BoxInt32(world, 100000);
+	UBoxedValueStatics::ReleaseBox(world, first);
+
+	const bool resetCorrect = first->Value == 0;
+	const bool pooledCorrect = UBoxedValuePool::Get(world)->GetNumPooled(UBoxedInt32::StaticClass()) == 1;
+
+	UBoxedInt32* second = UBoxedInt32::BoxInt32(world, 200000);
+	const bool recycledCorrect = second == first && second->Value == 200000;
+
+	world->DestroyWorld(false);
+
+	Context->TestTrue(TEXT("Released box should be reset"), resetCorrect);
+	Context->TestTrue(TEXT("Released box should be pooled"), pooledCorrect);
+	Context->TestTrue(TEXT("Pooled box should be reused for the next value"), recycledCorrect);
+
+	return resetCorrect && pooledCorrect && recycledCorrect;
+}
+
+bool TestDoubleReleaseIsIgnored(FAutomationTestBase* Context)
+{
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false);
+	Context->AddExpectedError(TEXT("released to the box pool twice"), EAutomationExpectedErrorFlags::Contains, 2);
+
+	UBoxedInt32* box = UBoxedInt32::BoxInt32(world, 100000);
+	UBoxedValueStatics::ReleaseBox(world, box);
+	UBoxedValueStatics::ReleaseBox(world, box);
+	UBoxedValueStatics::ReleaseBoxAtEndOfFrame(world, box);
+	FWorldDelegates::OnWorldPostActorTick.Broadcast(world, LEVELTICK_All, 0.0f);
+
+	const bool pooledCorrect = UBoxedValuePool::Get(world)->GetNumPooled(UBoxedInt32::StaticClass()) == 1;
+	UBoxedInt32* first = UBoxedInt32::BoxInt32(world, 200000);
+	UBoxedInt32* second = UBoxedInt32::BoxInt32(world, 300000);
+	const bool distinctCorrect = first == box && second != box && first->Value == 200000;
+
+	world->DestroyWorld(false);
+
+	Context->TestTrue(TEXT("A box released twice should only be pooled once"), pooledCorrect);
+	Context->TestTrue(TEXT("A box released twice should only be handed out once"), distinctCorrect);
+
+	return pooledCorrect && distinctCorrect;
+}
+
+bool TestBoxFromWorkerThread(FAutomationTestBase* Context)
+{
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false);
+	UBoxedValueStatics::ReleaseBox(world, UBoxedInt32::BoxInt32(world, 100000));
+	const UBoxedValuePool* pool = UBoxedValuePool::Get(world);
+	const int32 numPooled = pool->GetNumPooled(UBoxedInt32::StaticClass());
+
+	// Off the game thread the pool isn't touched at all, boxes are made fresh and releasing them does nothing
+	UBoxedInt32* box = nullptr;
+	bool bPoolFound = true;
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [world, &box, &bPoolFound]()
+	{
+		bPoolFound = UBoxedValuePool::Get(world) != nullptr;
+		box = UBoxedInt32::BoxInt32(world, 200000);
+		UBoxedValueStatics::ReleaseBox(world, box);
+		UBoxedValueStatics::ReleaseBoxAtEndOfFrame(world, box);
+	}).Wait();
+	FWorldDelegates::OnWorldPostActorTick.Broadcast(world, LEVELTICK_All, 0.0f);
+
+	const bool boxCorrect = !bPoolFound && box && box->Value == 200000;
+	const bool poolCorrect = pool->GetNumPooled(UBoxedInt32::StaticClass()) == numPooled;
+
+	world->DestroyWorld(false);
+
+	Context->TestTrue(TEXT("Boxing off the game thread should make a new box"), boxCorrect);
+	Context->TestTrue(TEXT("Releasing off the game thread should leave the pool alone"), poolCorrect);
+
+	return boxCorrect && poolCorrect;
+}
+
+bool TestCommonValuesAreInterned(FAutomationTestBase* Context)
+{
+	UObject* outer = GetTransientPackage();
+
+	const bool sharedCorrect = UBoxedInt32::BoxInt32(outer, 7) == UBoxedInt32::BoxInt32(outer, 7) &&
+		UBoxedBool::BoxBool(outer, false) == UBoxedBool::BoxBool(outer, false) &&
+		UBoxedString::BoxString(outer, FString()) == UBoxedString::BoxString(outer, FString());
+	const bool uniqueCorrect = UBoxedInt32::BoxInt32(outer, 7, true) != UBoxedInt32::BoxInt32(outer, 7);
+	const bool uncachedCorrect = UBoxedInt32::BoxInt32(outer, FBoxedValueCache::MaxCachedInteger + 1) !=
+		UBoxedInt32::BoxInt32(outer, FBoxedValueCache::MaxCachedInteger + 1);
+
+	Context->TestTrue(TEXT("Common values should share one box"), sharedCorrect);
+	Context->TestTrue(TEXT("Unique boxes should never be shared"), uniqueCorrect);
+	Context->TestTrue(TEXT("Values outside of the cache should get their own box"), uncachedCorrect);
+
+	return sharedCorrect && uniqueCorrect && uncachedCorrect;
+}
+
+bool TestInternedBoxesAreReadOnly(FAutomationTestBase* Context)
+{
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false);
+	Context->AddExpectedError(TEXT("is a shared box and can't be changed"), EAutomationExpectedErrorFlags::Contains, 1);
+
+	UBoxedInt32* shared = UBoxedInt32::BoxInt32(world, 7);
+	shared->SetValue(8);
+	UBoxedInt32* unique = UBoxedInt32::BoxInt32(world, 7, true);
+	unique->SetValue(8);
+	const bool writeCorrect = shared->Value == 7 && UBoxedInt32::BoxInt32(world, 7)->Value == 7 && unique->Value == 8;
+
+	// Rooting a box of its own doesn't make it a shared one
+	UBoxedInt32* rooted = NewObject<UBoxedInt32>(GetTransientPackage());
+	rooted->AddToRoot();
+	UBoxedValueStatics::ReleaseBox(world, rooted);
+	const bool rootedCorrect = !FBoxedValueCache::IsInterned(rooted) && FBoxedValueCache::IsInterned(shared) &&
+		UBoxedValuePool::Get(world)->GetNumPooled(UBoxedInt32::StaticClass()) == 1;
+	rooted->RemoveFromRoot();
+
+	world->DestroyWorld(false);
+
+	Context->TestTrue(TEXT("Only boxes of their own should be writable"), writeCorrect);
+	Context->TestTrue(TEXT("Only the canonical boxes should count as interned"), rootedCorrect);
+
+	return writeCorrect && rootedCorrect;
+}
+
+bool TestInternedBoxOnWorkerThread(FAutomationTestBase* Context)
+{
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false);
+	Context->AddExpectedError(TEXT("is a shared box and can't be changed"), EAutomationExpectedErrorFlags::Contains, 1);
+
+	// A canonical box handed to another thread is still read only there
+	UBoxedInt32* shared = UBoxedInt32::BoxInt32(world, 7);
+	bool bInterned = false;
+	bool bWritable = true;
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [shared, &bInterned, &bWritable]()
+	{
+		bInterned = FBoxedValueCache::IsInterned(shared);
+		bWritable = FBoxedValueCache::CanWrite(shared);
+	}).Wait();
+
+	const bool sharedCorrect = bInterned && !bWritable && shared->Value == 7;
+
+	world->DestroyWorld(false);
+
+	Context->TestTrue(TEXT("Interned boxes should be read only from any thread"), sharedCorrect);
+
+	return sharedCorrect;
+}
+
+bool TestTryUnbox(FAutomationTestBase* Context)
+{
+	const TScriptInterface<IBoxedType> value = UBoxedInt64::BoxInt64(GetTransientPackage(), 5000);
+
+	int64 actual = 0;
+	const bool successCorrect = UBoxedValueStatics::TryUnbox<UBoxedInt64>(value, actual) && actual == 5000;
+
+	FString untouched = TEXT("Untouched");
+	const bool failureCorrect = !UBoxedValueStatics::TryUnbox<UBoxedString>(value, untouched) &&
+		untouched == TEXT("Untouched") && UBoxedValueStatics::TryGetValuePtr<UBoxedString>(value) == nullptr;
+
+	Context->TestTrue(TEXT("TryUnbox should succeed with the matching box"), successCorrect);
+	Context->TestTrue(TEXT("TryUnbox should fail without writing for another box"), failureCorrect);
+
+	return successCorrect && failureCorrect;
+}
+
+bool TestBoxArray(FAutomationTestBase* Context)
+{
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false);
+	UBoxedValueStatics::ReleaseBox(world, UBoxedInt32::BoxInt32(world, 100000));
+	UBoxedValueStatics::ReleaseBox(world, UBoxedInt32::BoxInt32(world, 200000));
+
+	const TArray<int32> input = {7, 100000, 200000, 300000};
+	TArray<TScriptInterface<IBoxedType>> boxes = UBoxedInt32::BoxInt32Array(world, input);
+	const bool internedCorrect = boxes.Num() == 4 && boxes[0].GetObject() == UBoxedInt32::BoxInt32(world, 7);
+	const bool pooledCorrect = UBoxedValuePool::Get(world)->GetNumPooled(UBoxedInt32::StaticClass()) == 0;
+
+	boxes.Add(UBoxedString::BoxString(world, TEXT("Not an int")));
+	TArray<int32> output;
+	const int32 numUnboxed = UBoxedValueStatics::UnboxArray<UBoxedInt32>(boxes, output);
+	const bool unboxCorrect = numUnboxed == 4 && output == TArray<int32>({7, 100000, 200000, 300000, 0});
+
+	world->DestroyWorld(false);
+
+	Context->TestTrue(TEXT("Common values in an array should still share one box"), internedCorrect);
+	Context->TestTrue(TEXT("Every pooled box should be reused by the array"), pooledCorrect);
+	Context->TestTrue(TEXT("Unboxing should keep the order and default boxes of another kind"), unboxCorrect);
+
+	return internedCorrect && pooledCorrect && unboxCorrect;
+}
+
 const FString BoxedValueTests_BoxedBool = TEXT("BoxedValueTests_BoxedBool");
 const FString BoxedValueTests_BoxedByte = TEXT("BoxedValueTests_BoxedByte");
 const FString BoxedValueTests_BoxedInt32 = TEXT("BoxedValueTests_BoxedInt32");
@@ -138,6 +330,14 @@ const FString BoxedValueTests_BoxedTransform = TEXT("BoxedValueTests_BoxedTransf
 const FString BoxedValueTests_BoxedStruct = TEXT("BoxedValueTests_BoxedStruct");
 const FString BoxedValueTests_BoxedObject = TEXT("BoxedValueTests_BoxedObject");
 const FString BoxedValueTests_BoxCanBeChanged = TEXT("BoxedValueTests_BoxCanBeChanged");
+const FString BoxedValueTests_BoxesAreRecycled = TEXT("BoxedValueTests_BoxesAreRecycled");
+const FString BoxedValueTests_DoubleReleaseIsIgnored = TEXT("BoxedValueTests_DoubleReleaseIsIgnored");
+const FString BoxedValueTests_BoxFromWorkerThread = TEXT("BoxedValueTests_BoxFromWorkerThread");
+const FString BoxedValueTests_CommonValuesAreInterned = TEXT("BoxedValueTests_CommonValuesAreInterned");
+const FString BoxedValueTests_InternedBoxesAreReadOnly = TEXT("BoxedValueTests_InternedBoxesAreReadOnly");
+const FString BoxedValueTests_InternedBoxOnWorkerThread = TEXT("BoxedValueTests_InternedBoxOnWorkerThread");
+const FString BoxedValueTests_TryUnbox = TEXT("BoxedValueTests_TryUnbox");
+const FString BoxedValueTests_BoxArray = TEXT("BoxedValueTests_BoxArray");
 
 void BoxedValueTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
 {
@@ -159,6 +359,14 @@ void BoxedValueTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FStri
 		BoxedValueTests_BoxedStruct,
 		BoxedValueTests_BoxedObject,
 		BoxedValueTests_BoxCanBeChanged,
+		BoxedValueTests_BoxesAreRecycled,
+		BoxedValueTests_DoubleReleaseIsIgnored,
+		BoxedValueTests_BoxFromWorkerThread,
+		BoxedValueTests_CommonValuesAreInterned,
+		BoxedValueTests_InternedBoxesAreReadOnly,
+		BoxedValueTests_InternedBoxOnWorkerThread,
+		BoxedValueTests_TryUnbox,
+		BoxedValueTests_BoxArray,
 	};
 
 	for (const FString& test : tests)
@@ -232,6 +440,38 @@ bool BoxedValueTests::RunTest(const FString& Parameters)
 			BoxedValueTests_BoxCanBeChanged,
 			[this]() { return TestBoxCanBeChanged(this); }
 		},
+		{
+			BoxedValueTests_BoxesAreRecycled,
+			[this]() { return TestBoxesAreRecycled(this); }
+		},
+		{
+			BoxedValueTests_DoubleReleaseIsIgnored,
+			[this]() { return TestDoubleReleaseIsIgnored(this); }
+		},
+		{
+			BoxedValueTests_BoxFromWorkerThread,
+			[this]() { return TestBoxFromWorkerThread(this); }
+		},
+		{
+			BoxedValueTests_CommonValuesAreInterned,
+			[this]() { return TestCommonValuesAreInterned(this); }
+		},
+		{
+			BoxedValueTests_InternedBoxesAreReadOnly,
+			[this]() { return TestInternedBoxesAreReadOnly(this); }
+		},
+		{
+			BoxedValueTests_InternedBoxOnWorkerThread,
+			[this]() { return TestInternedBoxOnWorkerThread(this); }
+		},
+		{
+			BoxedValueTests_TryUnbox,
+			[this]() { return TestTryUnbox(this); }
+		},
+		{
+			BoxedValueTests_BoxArray,
+			[this]() { return TestBoxArray(this); }
+		},
 	};
 
 	if (tests.Contains(Parameters))
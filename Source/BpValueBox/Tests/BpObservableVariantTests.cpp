@@ -0,0 +1,225 @@
+﻿#include "Misc/AutomationTest.h"
+#include "BpObservableVariant.h"
+#include "BpVariant_Generated.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(BpObservableVariantTests, "Tests.BpObservableVariantTests",
+                                  EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool TestObservableVersions(FAutomationTestBase* Context)
+{
+	FBpObservableVariant observable;
+	const bool firstChanged = observable.Set(UBpVariantStatics::MakeVariantFromInt(1));
+	const bool sameChanged = observable.Set(UBpVariantStatics::MakeVariantFromInt(1));
+	const bool otherChanged = observable.Set(UBpVariantStatics::MakeVariantFromInt(2));
+
+	const bool changesCorrect = firstChanged && !sameChanged && otherChanged;
+	const bool versionCorrect = observable.GetVersion() == 2 && observable.HasChangedSince(1) &&
+		!observable.HasChangedSince(2) && UBpVariantStatics::GetInt(observable.Get()) == 2;
+
+	Context->TestTrue(TEXT("Only setting a different value should be a change"), changesCorrect);
+	Context->TestTrue(TEXT("Each change should count up the version"), versionCorrect);
+
+	return changesCorrect && versionCorrect;
+}
+
+bool TestListChangedSince(FAutomationTestBase* Context)
+{
+	FBpObservableVariantList list;
+	list.SetNum(4);
+	const uint64 start = list.GetVersion();
+
+	list.Set(2, UBpVariantStatics::MakeVariantFromInt(1));
+	list.Set(0, UBpVariantStatics::MakeVariantFromInt(1));
+	const uint64 middle = list.GetVersion();
+	// Enough changes to the same slot to compact the journal along the way
+	for (int32 i = 0; i < 100; ++i)
+	{
+		list.Set(2, UBpVariantStatics::MakeVariantFromInt(i + 2));
+	}
+	list.Set(3, UBpVariantStatics::MakeVariantFromInt(1));
+	list.Set(3, UBpVariantStatics::MakeVariantFromInt(1));
+
+	const bool newSlotsCorrect = list.GetChangedSince(0) == TArray<int32>{1, 0, 2, 3};
+	const bool sinceStartCorrect = list.GetChangedSince(start) == TArray<int32>{0, 2, 3};
+	const bool sinceMiddleCorrect = list.GetChangedSince(middle) == TArray<int32>{2, 3} &&
+		list.GetChangedSince(list.GetVersion()).IsEmpty();
+	const bool valuesCorrect = UBpVariantStatics::GetInt(list.Get(2)) == 101 && list.GetSlotVersion(1) <= start;
+
+	Context->TestTrue(TEXT("Added slots should count as changed"), newSlotsCorrect);
+	Context->TestTrue(TEXT("Each changed slot should be visited once, in the order of its latest change"),
+	                  sinceStartCorrect);
+	Context->TestTrue(TEXT("Only slots changed after the version should be visited"), sinceMiddleCorrect);
+	Context->TestTrue(TEXT("Slots should hold their latest value and version"), valuesCorrect);
+
+	return newSlotsCorrect && sinceStartCorrect && sinceMiddleCorrect && valuesCorrect;
+}
+
+bool TestListDirtyBits(FAutomationTestBase* Context)
+{
+	FBpObservableVariantList list;
+	list.SetNum(3);
+	list.ClearDirty();
+	const bool cleanCorrect = !list.IsDirty();
+
+	list.Set(1, UBpVariantStatics::MakeVariantFromString(TEXT("Value")));
+	list.Set(2, FBpVariant());
+	const bool dirtyCorrect = list.IsDirty() && !list.GetDirtyBits()[0] && list.GetDirtyBits()[1] &&
+		!list.GetDirtyBits()[2];
+
+	Context->TestTrue(TEXT("Clearing should leave no dirty slots"), cleanCorrect);
+	Context->TestTrue(TEXT("Only slots whose value changed should be dirty"), dirtyCorrect);
+
+	return cleanCorrect && dirtyCorrect;
+}
+
+bool TestListDelta(FAutomationTestBase* Context)
+{
+	FBpObservableVariantList source;
+	source.SetNum(3);
+	source.Set(0, UBpVariantStatics::MakeVariantFromInt(1));
+	source.Set(1, UBpVariantStatics::MakeVariantFromString(TEXT("One")));
+
+	FBpObservableVariantList target;
+	uint64 sent = 0;
+	uint64 received = 0;
+	TArray<uint8> full;
+	FMemoryWriter fullWriter(full);
+	source.SerializeDelta(fullWriter, sent);
+	FMemoryReader fullReader(full);
+	const bool fullApplied = target.SerializeDelta(fullReader, received);
+
+	source.Set(1, UBpVariantStatics::MakeVariantFromString(TEXT("Two")));
+	const uint64 targetVersion = target.GetVersion();
+	TArray<uint8> delta;
+	FMemoryWriter deltaWriter(delta);
+	source.SerializeDelta(deltaWriter, sent);
+	FMemoryReader deltaReader(delta);
+	const bool deltaApplied = target.SerializeDelta(deltaReader, received);
+
+	const bool fullCorrect = fullApplied && target.Num() == 3 && UBpVariantStatics::GetInt(target.Get(0)) == 1;
+	const bool deltaCorrect = deltaApplied && delta.Num() < full.Num() && received == source.GetVersion() &&
+		sent == source.GetVersion() && UBpVariantStatics::GetString(target.Get(1)) == TEXT("Two") &&
+		target.GetChangedSince(targetVersion) == TArray<int32>{1};
+
+	Context->TestTrue(TEXT("A delta since 0 should carry every slot"), fullCorrect);
+	Context->TestTrue(TEXT("A later delta should only carry the changed slots and change them on the target"),
+	                  deltaCorrect);
+
+	return fullCorrect && deltaCorrect;
+}
+
+bool TestListDeltaShrinks(FAutomationTestBase* Context)
+{
+	FBpObservableVariantList source;
+	source.SetNum(4);
+	FBpObservableVariantList target;
+	uint64 sent = 0;
+	uint64 received = 0;
+	TArray<uint8> full;
+	FMemoryWriter fullWriter(full);
+	source.SerializeDelta(fullWriter, sent);
+	FMemoryReader fullReader(full);
+	target.SerializeDelta(fullReader, received);
+
+	// Only the size changes, which consumers must still see as a new version
+	source.SetNum(2);
+	const bool versionCorrect = source.GetVersion() > sent && source.GetChangedSince(sent).IsEmpty();
+	TArray<uint8> delta;
+	FMemoryWriter deltaWriter(delta);
+	source.SerializeDelta(deltaWriter, sent);
+	FMemoryReader deltaReader(delta);
+	const bool shrinkCorrect = target.SerializeDelta(deltaReader, received) && target.Num() == 2 &&
+		received == source.GetVersion();
+
+	Context->TestTrue(TEXT("Removing slots should raise the version"), versionCorrect);
+	Context->TestTrue(TEXT("A delta after removing slots should shrink the target"), shrinkCorrect);
+
+	return versionCorrect && shrinkCorrect;
+}
+
+bool TestListDeltaRejectsBadCounts(FAutomationTestBase* Context)
+{
+	// A delta claiming far more slots than any list would have
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	uint64 version = 1;
+	uint32 num = MAX_uint32;
+	uint32 numChanged = 0;
+	writer << version;
+	writer.SerializeIntPacked(num);
+	writer.SerializeIntPacked(numChanged);
+
+	FBpObservableVariantList target;
+	uint64 received = 0;
+	FMemoryReader reader(bytes);
+	const bool rejectCorrect = !target.SerializeDelta(reader, received) && reader.IsError() && target.Num() == 0;
+
+	Context->TestTrue(TEXT("A delta with too many slots should be rejected before allocating"), rejectCorrect);
+
+	return rejectCorrect;
+}
+
+const FString BpObservableVariantTests_Versions = TEXT("BpObservableVariantTests_Versions");
+const FString BpObservableVariantTests_ChangedSince = TEXT("BpObservableVariantTests_ChangedSince");
+const FString BpObservableVariantTests_DirtyBits = TEXT("BpObservableVariantTests_DirtyBits");
+const FString BpObservableVariantTests_Delta = TEXT("BpObservableVariantTests_Delta");
+const FString BpObservableVariantTests_DeltaShrinks = TEXT("BpObservableVariantTests_DeltaShrinks");
+const FString BpObservableVariantTests_DeltaRejectsBadCounts = TEXT("BpObservableVariantTests_DeltaRejectsBadCounts");
+
+void BpObservableVariantTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FString> tests =
+	{
+		BpObservableVariantTests_Versions,
+		BpObservableVariantTests_ChangedSince,
+		BpObservableVariantTests_DirtyBits,
+		BpObservableVariantTests_Delta,
+		BpObservableVariantTests_DeltaShrinks,
+		BpObservableVariantTests_DeltaRejectsBadCounts,
+	};
+
+	for (const FString& test : tests)
+	{
+		OutBeautifiedNames.Add(test);
+		OutTestCommands.Add(test);
+	}
+}
+
+bool BpObservableVariantTests::RunTest(const FString& Parameters)
+{
+	TMap<FString, TFunction<bool()>> tests =
+	{
+		{
+			BpObservableVariantTests_Versions,
+			[this]() { return TestObservableVersions(this); }
+		},
+		{
+			BpObservableVariantTests_ChangedSince,
+			[this]() { return TestListChangedSince(this); }
+		},
+		{
+			BpObservableVariantTests_DirtyBits,
+			[this]() { return TestListDirtyBits(this); }
+		},
+		{
+			BpObservableVariantTests_Delta,
+			[this]() { return TestListDelta(this); }
+		},
+		{
+			BpObservableVariantTests_DeltaShrinks,
+			[this]() { return TestListDeltaShrinks(this); }
+		},
+		{
+			BpObservableVariantTests_DeltaRejectsBadCounts,
+			[this]() { return TestListDeltaRejectsBadCounts(this); }
+		},
+	};
+
+	if (tests.Contains(Parameters))
+	{
+		return tests[Parameters]();
+	}
+	return true;
+}
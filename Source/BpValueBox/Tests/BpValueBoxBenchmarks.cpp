@@ -0,0 +1,532 @@
+﻿#include "Misc/AutomationTest.h"
+#include "BoxedValue.h"
+#include "BoxedValue_Generated.h"
+#include "BpVariant_Generated.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTime.h"
+#include "TestObject.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/GarbageCollection.h"
+
+/*
+Benchmarks for BpVariant, BoxedValue, FVariant and FInstancedStruct. These are excluded from the regular test runs
+through the perf filter. To run them headless:
+UnrealEditor-Cmd <Project> -ExecCmds="Automation RunTests Tests.BpValueBoxBenchmarks;Quit" -nullrhi -unattended
+Each benchmark writes its results to Saved/Automation/BpValueBoxBenchmarks/<Benchmark>.json.
+Pass -BpValueBoxBenchmarkIterations=N to change how many times each operation runs.
+*/
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(BpValueBoxBenchmarks, "Tests.BpValueBoxBenchmarks",
+                                  EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+namespace
+{
+	struct FBenchmarkResult
+	{
+		FString Name;
+		double Value = 0;
+		FString Unit;
+		double AllocationsPerOp = 0;
+	};
+
+	/*
+	Forwards to the real allocator while counting the allocations of threads that asked for it. It is installed as
+	GMalloc the first time it's needed and never removed or freed, since other threads may have already loaded it.
+	*/
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		static FCountingMalloc& Get()
+		{
+			static FCountingMalloc* counter = []()
+			{
+				FCountingMalloc* installed = new FCountingMalloc(GMalloc);
+				GMalloc = installed;
+				return installed;
+			}();
+			return *counter;
+		}
+
+		// Counts the calling thread's allocations until EndCounting, which returns how many there were
+		void BeginCounting()
+		{
+			NumAllocations = 0;
+			bCounting = true;
+		}
+
+		uint64 EndCounting()
+		{
+			bCounting = false;
+			return NumAllocations;
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				CountAllocation();
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			Inner->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("BpValueBoxCountingMalloc"); }
+
+	private:
+		explicit FCountingMalloc(FMalloc* InInner)
+			: Inner(InInner)
+		{
+		}
+
+		void CountAllocation()
+		{
+			if (bCounting)
+			{
+				++NumAllocations;
+			}
+		}
+
+		FMalloc* const Inner;
+
+		static inline thread_local bool bCounting = false;
+		static inline thread_local uint64 NumAllocations = 0;
+	};
+
+	// Keeps the compiler from optimizing away the work being measured
+	const void* volatile GBenchmarkSink = nullptr;
+
+	template <typename T>
+	FORCEINLINE void Consume(const T& Value)
+	{
+		GBenchmarkSink = &Value;
+	}
+
+	int32 GetIterations()
+	{
+		int32 iterations = 100000;
+		FParse::Value(FCommandLine::Get(), TEXT("BpValueBoxBenchmarkIterations="), iterations);
+		return FMath::Max(iterations, 1);
+	}
+
+	template <typename TFunc>
+	FBenchmarkResult RunBenchmark(const FString& Name, const int32 Iterations, TFunc&& Func)
+	{
+		for (int32 i = 0; i < Iterations / 10 + 1; ++i)
+		{
+			Func();
+		}
+
+		const uint64 start = FPlatformTime::Cycles64();
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			Func();
+		}
+		const uint64 end = FPlatformTime::Cycles64();
+
+		// Allocations are counted in a separate pass so the counting doesn't show up in the timings
+		FCountingMalloc& counter = FCountingMalloc::Get();
+		counter.BeginCounting();
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			Func();
+		}
+		const uint64 numAllocations = counter.EndCounting();
+
+		FBenchmarkResult result;
+		result.Name = Name;
+		result.Value = FPlatformTime::ToSeconds64(end - start) * 1e9 / Iterations;
+		result.Unit = TEXT("ns/op");
+		result.AllocationsPerOp = static_cast<double>(numAllocations) / Iterations;
+		return result;
+	}
+
+	template <typename T>
+	void AddBpVariantBenchmarks(TArray<FBenchmarkResult>& Results, const FString& TypeName, const T& Input)
+	{
+		const int32 iterations = GetIterations();
+		FBpVariant variant = UBpVariantStatics::MakeFromGeneric(Input);
+		const FBpVariant other = variant;
+
+		Results.Add(RunBenchmark(TypeName + TEXT(".Make"), iterations, [&Input]()
+		{
+			const FBpVariant value = UBpVariantStatics::MakeFromGeneric(Input);
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Set"), iterations, [&Input, &variant]()
+		{
+			UBpVariantStatics::SetValue(variant, Input);
+			Consume(variant);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Get"), iterations, [&variant]()
+		{
+			const T value = UBpVariantStatics::GetValue<T>(variant);
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Equals"), iterations, [&variant, &other]()
+		{
+			const bool value = UBpVariantStatics::Equals(variant, other);
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Copy"), iterations, [&variant]()
+		{
+			const FBpVariant value = variant;
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".GetType"), iterations, [&variant]()
+		{
+			const EValueType value = UBpVariantStatics::GetType(variant);
+			Consume(value);
+		}));
+	}
+
+	template <typename T>
+	void AddFVariantBenchmarks(TArray<FBenchmarkResult>& Results, const FString& TypeName, const T& Input)
+	{
+		const int32 iterations = GetIterations();
+		const FVariant variant = Input;
+		const FVariant other = variant;
+
+		Results.Add(RunBenchmark(TypeName + TEXT(".Make"), iterations, [&Input]()
+		{
+			const FVariant value = Input;
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Get"), iterations, [&variant]()
+		{
+			const T value = variant.GetValue<T>();
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Equals"), iterations, [&variant, &other]()
+		{
+			const bool value = variant == other;
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Copy"), iterations, [&variant]()
+		{
+			const FVariant value = variant;
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".GetType"), iterations, [&variant]()
+		{
+			const EVariantTypes value = variant.GetType();
+			Consume(value);
+		}));
+	}
+
+	template <typename T>
+	void AddInstancedStructBenchmarks(TArray<FBenchmarkResult>& Results, const FString& TypeName, const T& Input)
+	{
+		const int32 iterations = GetIterations();
+		const FInstancedStruct instancedStruct = FInstancedStruct::Make(Input);
+		const FInstancedStruct other = instancedStruct;
+
+		Results.Add(RunBenchmark(TypeName + TEXT(".Make"), iterations, [&Input]()
+		{
+			const FInstancedStruct value = FInstancedStruct::Make(Input);
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Get"), iterations, [&instancedStruct]()
+		{
+			const T value = instancedStruct.Get<T>();
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Equals"), iterations, [&instancedStruct, &other]()
+		{
+			const bool value = instancedStruct == other;
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Copy"), iterations, [&instancedStruct]()
+		{
+			const FInstancedStruct value = instancedStruct;
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".GetType"), iterations, [&instancedStruct]()
+		{
+			const UScriptStruct* value = instancedStruct.GetScriptStruct();
+			Consume(value);
+		}));
+	}
+
+	template <typename TBoxType, typename T>
+	void AddBoxedValueBenchmarks(TArray<FBenchmarkResult>& Results, const FString& TypeName, const T& Input)
+	{
+		const int32 iterations = GetIterations();
+		UObject* outer = GetTransientPackage();
+		const TScriptInterface<IBoxedType> box = UBoxedValueStatics::BoxValue<TBoxType>(outer, Input, true);
+
+		Results.Add(RunBenchmark(TypeName + TEXT(".Box"), iterations, [outer, &Input]()
+		{
+			const TBoxType* value = UBoxedValueStatics::BoxValue<TBoxType>(outer, Input, true);
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".BoxInterned"), iterations, [outer, &Input]()
+		{
+			const TBoxType* value = UBoxedValueStatics::BoxValue<TBoxType>(outer, Input);
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".Unbox"), iterations, [&box]()
+		{
+			const T value = UBoxedValueStatics::GetValue<T, TBoxType>(box);
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".GetType"), iterations, [&box]()
+		{
+			const EValueType value = UBoxedValueStatics::GetBoxType(box);
+			Consume(value);
+		}));
+		Results.Add(RunBenchmark(TypeName + TEXT(".ExecuteGetType"), iterations, [&box]()
+		{
+			const EValueType value = IBoxedType::Execute_GetType(box.GetObject());
+			Consume(value);
+		}));
+
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	FBenchmarkResult MakeSizeResult(const FString& Name, const SIZE_T Size)
+	{
+		FBenchmarkResult result;
+		result.Name = Name;
+		result.Value = Size;
+		result.Unit = TEXT("bytes");
+		return result;
+	}
+
+	double TimeGarbageCollection()
+	{
+		const uint64 start = FPlatformTime::Cycles64();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+		return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - start);
+	}
+
+	void AddGarbageCollectionBenchmarks(TArray<FBenchmarkResult>& Results)
+	{
+		const double baseline = TimeGarbageCollection();
+
+		for (const int32 numBoxes : {1000, 10000, 100000})
+		{
+			TArray<UObject*> boxes;
+			boxes.Reserve(numBoxes);
+			for (int32 i = 0; i < numBoxes; ++i)
+			{
+				UObject* box = UBoxedValueStatics::BoxValue<UBoxedInt32>(GetTransientPackage(), i, true);
+				box->AddToRoot();
+				boxes.Add(box);
+			}
+
+			FBenchmarkResult result;
+			result.Name = FString::Printf(TEXT("GarbageCollection.LiveBoxes.%d"), numBoxes);
+			result.Value = TimeGarbageCollection() - baseline;
+			result.Unit = TEXT("ms");
+			Results.Add(result);
+
+			for (UObject* box : boxes)
+			{
+				box->RemoveFromRoot();
+			}
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+		}
+	}
+
+	// GC cost should only grow with the variants that hold objects, the other arms are skipped without a lookup
+	void AddVariantGarbageCollectionBenchmarks(TArray<FBenchmarkResult>& Results)
+	{
+		UTestVariantHolder* holder = NewObject<UTestVariantHolder>();
+		holder->AddToRoot();
+		const double baseline = TimeGarbageCollection();
+
+		for (const int32 numVariants : {1000, 10000, 100000})
+		{
+			for (const bool bHoldsObjects : {false, true})
+			{
+				holder->Variants.Reset();
+				holder->Variants.Reserve(numVariants);
+				for (int32 i = 0; i < numVariants; ++i)
+				{
+					holder->Variants.Add(bHoldsObjects
+						                     ? UBpVariantStatics::MakeVariantFromObject(holder)
+						                     : UBpVariantStatics::MakeVariantFromInt(i));
+				}
+
+				FBenchmarkResult result;
+				result.Name = FString::Printf(TEXT("GarbageCollection.%sVariants.%d"),
+				                              bHoldsObjects ? TEXT("Object") : TEXT("Int32"), numVariants);
+				result.Value = TimeGarbageCollection() - baseline;
+				result.Unit = TEXT("ms");
+				Results.Add(result);
+			}
+		}
+
+		holder->RemoveFromRoot();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+	}
+
+	FString ToJson(const FString& Benchmark, const TArray<FBenchmarkResult>& Results)
+	{
+		FString json = FString::Printf(TEXT("{\n\t\"benchmark\": \"%s\",\n\t\"results\": ["), *Benchmark);
+		for (int32 i = 0; i < Results.Num(); ++i)
+		{
+			const FBenchmarkResult& result = Results[i];
+			json += FString::Printf(
+				TEXT("%s\n\t\t{\"name\": \"%s\", \"value\": %.3f, \"unit\": \"%s\", \"allocations_per_op\": %.3f}"),
+				i == 0 ? TEXT("") : TEXT(","), *result.Name, result.Value, *result.Unit, result.AllocationsPerOp);
+		}
+		json += TEXT("\n\t]\n}\n");
+		return json;
+	}
+}
+
+const FString BpValueBoxBenchmarks_BpVariant = TEXT("BpValueBoxBenchmarks_BpVariant");
+const FString BpValueBoxBenchmarks_FVariant = TEXT("BpValueBoxBenchmarks_FVariant");
+const FString BpValueBoxBenchmarks_InstancedStruct = TEXT("BpValueBoxBenchmarks_InstancedStruct");
+const FString BpValueBoxBenchmarks_BoxedValue = TEXT("BpValueBoxBenchmarks_BoxedValue");
+const FString BpValueBoxBenchmarks_Sizes = TEXT("BpValueBoxBenchmarks_Sizes");
+const FString BpValueBoxBenchmarks_GarbageCollection = TEXT("BpValueBoxBenchmarks_GarbageCollection");
+
+void BpValueBoxBenchmarks::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FString> tests =
+	{
+		BpValueBoxBenchmarks_BpVariant,
+		BpValueBoxBenchmarks_FVariant,
+		BpValueBoxBenchmarks_InstancedStruct,
+		BpValueBoxBenchmarks_BoxedValue,
+		BpValueBoxBenchmarks_Sizes,
+		BpValueBoxBenchmarks_GarbageCollection,
+	};
+
+	for (const FString& test : tests)
+	{
+		OutBeautifiedNames.Add(test);
+		OutTestCommands.Add(test);
+	}
+}
+
+bool BpValueBoxBenchmarks::RunTest(const FString& Parameters)
+{
+	TMap<FString, TFunction<void(TArray<FBenchmarkResult>&)>> benchmarks =
+	{
+		{
+			BpValueBoxBenchmarks_BpVariant,
+			[](TArray<FBenchmarkResult>& Results)
+			{
+				AddBpVariantBenchmarks(Results, TEXT("BpVariant.Bool"), true);
+				AddBpVariantBenchmarks(Results, TEXT("BpVariant.Int32"), static_cast<int32>(1));
+				AddBpVariantBenchmarks(Results, TEXT("BpVariant.Float64"), static_cast<double>(1));
+				AddBpVariantBenchmarks(Results, TEXT("BpVariant.Name"), FName(TEXT("BpValueBoxBenchmarks")));
+				AddBpVariantBenchmarks(Results, TEXT("BpVariant.String"), FGuid::NewGuid().ToString());
+				AddBpVariantBenchmarks(Results, TEXT("BpVariant.Vector"), FVector(1, 2, 3));
+				AddBpVariantBenchmarks(Results, TEXT("BpVariant.Transform"), FTransform(FVector(1, 2, 3)));
+				AddBpVariantBenchmarks(Results, TEXT("BpVariant.Struct"), FInstancedStruct::Make(FVector(1, 2, 3)));
+				AddBpVariantBenchmarks(Results, TEXT("BpVariant.Object"),
+				                       static_cast<UObject*>(GetTransientPackage()));
+			}
+		},
+		{
+			BpValueBoxBenchmarks_FVariant,
+			[](TArray<FBenchmarkResult>& Results)
+			{
+				AddFVariantBenchmarks(Results, TEXT("FVariant.Bool"), true);
+				AddFVariantBenchmarks(Results, TEXT("FVariant.Int32"), static_cast<int32>(1));
+				AddFVariantBenchmarks(Results, TEXT("FVariant.Float64"), static_cast<double>(1));
+				AddFVariantBenchmarks(Results, TEXT("FVariant.Name"), FName(TEXT("BpValueBoxBenchmarks")));
+				AddFVariantBenchmarks(Results, TEXT("FVariant.String"), FGuid::NewGuid().ToString());
+				AddFVariantBenchmarks(Results, TEXT("FVariant.Vector"), FVector(1, 2, 3));
+				AddFVariantBenchmarks(Results, TEXT("FVariant.Transform"), FTransform(FVector(1, 2, 3)));
+			}
+		},
+		{
+			BpValueBoxBenchmarks_InstancedStruct,
+			[](TArray<FBenchmarkResult>& Results)
+			{
+				AddInstancedStructBenchmarks(Results, TEXT("InstancedStruct.Vector"), FVector(1, 2, 3));
+				AddInstancedStructBenchmarks(Results, TEXT("InstancedStruct.Transform"),
+				                             FTransform(FVector(1, 2, 3)));
+			}
+		},
+		{
+			BpValueBoxBenchmarks_BoxedValue,
+			[](TArray<FBenchmarkResult>& Results)
+			{
+				AddBoxedValueBenchmarks<UBoxedBool>(Results, TEXT("BoxedValue.Bool"), true);
+				AddBoxedValueBenchmarks<UBoxedInt32>(Results, TEXT("BoxedValue.Int32"), static_cast<int32>(1));
+				AddBoxedValueBenchmarks<UBoxedFloat64>(Results, TEXT("BoxedValue.Float64"), static_cast<double>(1));
+				AddBoxedValueBenchmarks<UBoxedName>(Results, TEXT("BoxedValue.Name"),
+				                                    FName(TEXT("BpValueBoxBenchmarks")));
+				AddBoxedValueBenchmarks<UBoxedString>(Results, TEXT("BoxedValue.String"),
+				                                      FGuid::NewGuid().ToString());
+				AddBoxedValueBenchmarks<UBoxedVector>(Results, TEXT("BoxedValue.Vector"), FVector(1, 2, 3));
+				AddBoxedValueBenchmarks<UBoxedTransform>(Results, TEXT("BoxedValue.Transform"),
+				                                         FTransform(FVector(1, 2, 3)));
+			}
+		},
+		{
+			BpValueBoxBenchmarks_Sizes,
+			[](TArray<FBenchmarkResult>& Results)
+			{
+				Results.Add(MakeSizeResult(TEXT("Size.BpVariant"), sizeof(FBpVariant)));
+				Results.Add(MakeSizeResult(TEXT("Size.FVariant"), sizeof(FVariant)));
+				Results.Add(MakeSizeResult(TEXT("Size.InstancedStruct"), sizeof(FInstancedStruct)));
+				Results.Add(MakeSizeResult(TEXT("Size.BoxedInt32"), UBoxedInt32::StaticClass()->GetStructureSize()));
+				Results.Add(MakeSizeResult(TEXT("Size.BoxedTransform"),
+				                           UBoxedTransform::StaticClass()->GetStructureSize()));
+			}
+		},
+		{
+			BpValueBoxBenchmarks_GarbageCollection,
+			[](TArray<FBenchmarkResult>& Results)
+			{
+				AddGarbageCollectionBenchmarks(Results);
+				AddVariantGarbageCollectionBenchmarks(Results);
+			}
+		},
+	};
+
+	if (!benchmarks.Contains(Parameters))
+	{
+		return true;
+	}
+
+	TArray<FBenchmarkResult> results;
+	benchmarks[Parameters](results);
+
+	for (const FBenchmarkResult& result : results)
+	{
+		AddInfo(FString::Printf(TEXT("%s: %.3f %s, %.3f allocations/op"), *result.Name, result.Value, *result.Unit,
+		                        result.AllocationsPerOp));
+	}
+
+	const FString outPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Automation"),
+	                                        TEXT("BpValueBoxBenchmarks"), Parameters + TEXT(".json"));
+	return TestTrue(TEXT("Benchmark results should be written"),
+	                FFileHelper::SaveStringToFile(ToJson(Parameters, results), *outPath));
+}
@@ -0,0 +1,317 @@
+﻿#include "Misc/AutomationTest.h"
+#include "BpVariantArray.h"
+#include "BpVariant_Generated.h"
+#include "ValueType.h"
+#include "TestObject.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(BpVariantArrayTests, "Tests.BpVariantArrayTests",
+								  EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+TArray<FBpVariant> MakeMixedVariants()
+{
+	return {
+		UBpVariantStatics::MakeVariantFromInt(1),
+		UBpVariantStatics::MakeVariantFromString(TEXT("One")),
+		UBpVariantStatics::MakeVariantFromDouble(1.5),
+		UBpVariantStatics::MakeVariantFromInt(2),
+		UBpVariantStatics::MakeVariantFromText(FText::FromString(TEXT("Two"))),
+		UBpVariantStatics::MakeVariantFromString(TEXT("Three")),
+		UBpVariantStatics::MakeVariantFromInt(3),
+		FBpVariant(),
+	};
+}
+
+bool TestArrayMatches(FAutomationTestBase* Context, const FBpVariantArray& Array, const TArray<FBpVariant>& Expected)
+{
+	bool bSuccess = Array.Num() == Expected.Num();
+	for (int32 i = 0; bSuccess && i < Expected.Num(); ++i)
+	{
+		bSuccess = Array.GetType(i) == Expected[i].GetType() && UBpVariantStatics::Equals(Array.Get(i), Expected[i]);
+	}
+
+	Context->TestTrue(TEXT("Array elements should match the variants that were added"), bSuccess);
+
+	return bSuccess;
+}
+
+bool TestAddAndGet(FAutomationTestBase* Context)
+{
+	const TArray<FBpVariant> variants = MakeMixedVariants();
+	FBpVariantArray array;
+	for (const FBpVariant& variant : variants)
+	{
+		array.Add(variant);
+	}
+
+	const bool columnCorrect = array.GetInt32s().Num() == 3 && array.GetInt32s()[0] == 1 && array.GetInt32s()[2] == 3;
+	const bool stringCorrect = array.GetStringView(5) == TEXT("Three");
+
+	Context->TestTrue(TEXT("Int column should hold every int in element order"), columnCorrect);
+	Context->TestTrue(TEXT("String view should read from the arena"), stringCorrect);
+
+	return TestArrayMatches(Context, array, variants) && columnCorrect && stringCorrect;
+}
+
+bool TestSetAndRemove(FAutomationTestBase* Context)
+{
+	TArray<FBpVariant> variants = MakeMixedVariants();
+	FBpVariantArray array;
+	for (const FBpVariant& variant : variants)
+	{
+		array.Add(variant);
+	}
+
+	// Same column, a longer string, then a change of column in the middle of the ints
+	variants[1] = UBpVariantStatics::MakeVariantFromString(TEXT("A much longer string than before"));
+	array.Set(1, variants[1]);
+	variants[3] = UBpVariantStatics::MakeVariantFromName(TEXT("Two"));
+	array.Set(3, variants[3]);
+	variants[2] = UBpVariantStatics::MakeVariantFromInt(4);
+	array.Set(2, variants[2]);
+	variants.RemoveAt(0);
+	array.RemoveAt(0);
+
+	const bool columnCorrect = array.GetInt32s().Num() == 2 && array.GetInt32s()[0] == 4 && array.GetInt32s()[1] == 3;
+
+	Context->TestTrue(TEXT("Int column should stay in element order"), columnCorrect);
+
+	return TestArrayMatches(Context, array, variants) && columnCorrect;
+}
+
+bool TestFindIndicesOfType(FAutomationTestBase* Context)
+{
+	FBpVariantArray array;
+	for (const FBpVariant& variant : MakeMixedVariants())
+	{
+		array.Add(variant);
+	}
+
+	TArray<int32> indices;
+	array.FindIndicesOfType(EValueType::String, indices);
+
+	const bool indicesCorrect = indices == TArray<int32>({1, 5});
+	const bool countCorrect = array.CountOfType(EValueType::Int32) == 3;
+
+	Context->TestTrue(TEXT("Should find the index of every string"), indicesCorrect);
+	Context->TestTrue(TEXT("Should count every int"), countCorrect);
+
+	return indicesCorrect && countCorrect;
+}
+
+bool TestArraySerializeRoundTrips(FAutomationTestBase* Context)
+{
+	const TArray<FBpVariant> variants = MakeMixedVariants();
+	FBpVariantArray written;
+	for (const FBpVariant& variant : variants)
+	{
+		written.Add(variant);
+	}
+
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	written.Serialize(writer);
+
+	FBpVariantArray actual;
+	FMemoryReader reader(bytes);
+	actual.Serialize(reader);
+
+	return TestArrayMatches(Context, actual, variants);
+}
+
+bool TestStringArenaIsCompacted(FAutomationTestBase* Context)
+{
+	FBpVariantArray array;
+	array.Add(UBpVariantStatics::MakeVariantFromString(TEXT("Keep")));
+	for (int32 i = 0; i < 1000; ++i)
+	{
+		array.Add(UBpVariantStatics::MakeVariantFromString(FString::Printf(TEXT("Removed %d"), i)));
+		array.RemoveAt(1);
+		array.Set(0, UBpVariantStatics::MakeVariantFromString(FString::Printf(TEXT("Keep %d"), i)));
+	}
+
+	const bool boundedCorrect = array.GetStringArenaNum() < 1024;
+	const bool valueCorrect = array.Num() == 1 && array.GetStringView(0) == TEXT("Keep 999");
+
+	Context->TestTrue(TEXT("Removed and replaced strings should not grow the arena without bound"), boundedCorrect);
+	Context->TestTrue(TEXT("Compacting the arena should keep the live strings"), valueCorrect);
+
+	return boundedCorrect && valueCorrect;
+}
+
+bool TestArrayRejectsBadCounts(FAutomationTestBase* Context)
+{
+	// An empty array's tags and columns, followed by the string and other counts
+	auto makeBytes = [](int32 NumStrings, int32 NumOthers)
+	{
+		TArray<uint8> bytes;
+		FMemoryWriter writer(bytes);
+		int32 empty = 0;
+		for (int32 i = 0; i < 10; ++i)
+		{
+			writer << empty;
+		}
+		writer << NumStrings;
+		writer << NumOthers;
+		return bytes;
+	};
+
+	bool bSuccess = true;
+	for (const TArray<uint8>& bytes : {makeBytes(-5, 0), makeBytes(0, MAX_int32), makeBytes(3, 0)})
+	{
+		FBpVariantArray array;
+		array.Add(UBpVariantStatics::MakeVariantFromInt(1));
+		FMemoryReader reader(bytes);
+		array.Serialize(reader);
+		bSuccess &= reader.IsError() && array.Num() == 0;
+	}
+
+	Context->TestTrue(TEXT("Counts that can't match the tags should fail to load"), bSuccess);
+
+	return bSuccess;
+}
+
+bool TestArraySavedAgainstDefaults(FAutomationTestBase* Context)
+{
+	// Properties are only saved when they differ from the class defaults, which takes comparing the elements
+	const TArray<FBpVariant> variants = MakeMixedVariants();
+	UTestVariantHolder* written = NewObject<UTestVariantHolder>();
+	for (const FBpVariant& variant : variants)
+	{
+		written->VariantArray.Add(variant);
+	}
+
+	UScriptStruct* arrayStruct = FBpVariantArray::StaticStruct();
+	const FBpVariantArray& defaults = GetDefault<UTestVariantHolder>()->VariantArray;
+	const bool changedCorrect = !arrayStruct->CompareScriptStruct(&written->VariantArray, &defaults, 0);
+
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	FObjectAndNameAsStringProxyArchive writerProxy(writer, false);
+	written->Serialize(writerProxy);
+
+	UTestVariantHolder* loaded = NewObject<UTestVariantHolder>();
+	FMemoryReader reader(bytes);
+	FObjectAndNameAsStringProxyArchive readerProxy(reader, false);
+	loaded->Serialize(readerProxy);
+	const bool loadCorrect = !reader.IsError() && TestArrayMatches(Context, loaded->VariantArray, variants);
+
+	// Characters left in the arena by a replaced string aren't part of the value
+	FBpVariantArray replaced;
+	replaced.Add(UBpVariantStatics::MakeVariantFromString(TEXT("Before")));
+	replaced.Set(0, UBpVariantStatics::MakeVariantFromString(TEXT("After")));
+	FBpVariantArray fresh;
+	fresh.Add(UBpVariantStatics::MakeVariantFromString(TEXT("After")));
+	FBpVariantArray other;
+	other.Add(UBpVariantStatics::MakeVariantFromString(TEXT("after")));
+	const bool identicalCorrect = arrayStruct->CompareScriptStruct(&replaced, &fresh, 0) &&
+		!arrayStruct->CompareScriptStruct(&fresh, &other, 0);
+
+	Context->TestTrue(TEXT("Variant array with elements should differ from the empty default"), changedCorrect);
+	Context->TestTrue(TEXT("Variant array saved against its defaults should load back"), loadCorrect);
+	Context->TestTrue(TEXT("Variant arrays should compare by their elements"), identicalCorrect);
+
+	return changedCorrect && loadCorrect && identicalCorrect;
+}
+
+bool TestArrayKeepsObjectAlive(FAutomationTestBase* Context)
+{
+	UTestVariantHolder* holder = NewObject<UTestVariantHolder>();
+	holder->AddToRoot();
+
+	const TWeakObjectPtr<UTestObject> object = NewObject<UTestObject>();
+	holder->VariantArray.Add(UBpVariantStatics::MakeVariantFromInt(1));
+	holder->VariantArray.Add(UBpVariantStatics::MakeVariantFromObject(object.Get()));
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+	const bool aliveCorrect = object.IsValid();
+
+	holder->VariantArray.Reset();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+	const bool collectedCorrect = !object.IsValid();
+
+	holder->RemoveFromRoot();
+
+	Context->TestTrue(TEXT("Object held by a variant array should survive garbage collection"), aliveCorrect);
+	Context->TestTrue(TEXT("Object should be collected once no variant array holds it"), collectedCorrect);
+
+	return aliveCorrect && collectedCorrect;
+}
+
+const FString BpVariantArrayTests_AddAndGet = TEXT("BpVariantArrayTests_AddAndGet");
+const FString BpVariantArrayTests_SetAndRemove = TEXT("BpVariantArrayTests_SetAndRemove");
+const FString BpVariantArrayTests_FindIndicesOfType = TEXT("BpVariantArrayTests_FindIndicesOfType");
+const FString BpVariantArrayTests_SerializeRoundTrips = TEXT("BpVariantArrayTests_SerializeRoundTrips");
+const FString BpVariantArrayTests_StringArenaIsCompacted = TEXT("BpVariantArrayTests_StringArenaIsCompacted");
+const FString BpVariantArrayTests_RejectsBadCounts = TEXT("BpVariantArrayTests_RejectsBadCounts");
+const FString BpVariantArrayTests_ArraySavedAgainstDefaults = TEXT("BpVariantArrayTests_ArraySavedAgainstDefaults");
+const FString BpVariantArrayTests_ArrayKeepsObjectAlive = TEXT("BpVariantArrayTests_ArrayKeepsObjectAlive");
+
+void BpVariantArrayTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FString> tests =
+	{
+		BpVariantArrayTests_AddAndGet,
+		BpVariantArrayTests_SetAndRemove,
+		BpVariantArrayTests_FindIndicesOfType,
+		BpVariantArrayTests_SerializeRoundTrips,
+		BpVariantArrayTests_StringArenaIsCompacted,
+		BpVariantArrayTests_RejectsBadCounts,
+		BpVariantArrayTests_ArraySavedAgainstDefaults,
+		BpVariantArrayTests_ArrayKeepsObjectAlive,
+	};
+
+	for (const FString& test : tests)
+	{
+		OutBeautifiedNames.Add(test);
+		OutTestCommands.Add(test);
+	}
+}
+
+bool BpVariantArrayTests::RunTest(const FString& Parameters)
+{
+	TMap<FString, TFunction<bool()>> tests =
+	{
+		{
+			BpVariantArrayTests_AddAndGet,
+			[this]() { return TestAddAndGet(this); }
+		},
+		{
+			BpVariantArrayTests_SetAndRemove,
+			[this]() { return TestSetAndRemove(this); }
+		},
+		{
+			BpVariantArrayTests_FindIndicesOfType,
+			[this]() { return TestFindIndicesOfType(this); }
+		},
+		{
+			BpVariantArrayTests_SerializeRoundTrips,
+			[this]() { return TestArraySerializeRoundTrips(this); }
+		},
+		{
+			BpVariantArrayTests_StringArenaIsCompacted,
+			[this]() { return TestStringArenaIsCompacted(this); }
+		},
+		{
+			BpVariantArrayTests_RejectsBadCounts,
+			[this]() { return TestArrayRejectsBadCounts(this); }
+		},
+		{
+			BpVariantArrayTests_ArraySavedAgainstDefaults,
+			[this]() { return TestArraySavedAgainstDefaults(this); }
+		},
+		{
+			BpVariantArrayTests_ArrayKeepsObjectAlive,
+			[this]() { return TestArrayKeepsObjectAlive(this); }
+		},
+	};
+
+	if (tests.Contains(Parameters))
+	{
+		return tests[Parameters]();
+	}
+	return true;
+}
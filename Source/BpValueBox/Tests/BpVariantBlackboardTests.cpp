@@ -0,0 +1,266 @@
+﻿#include "Misc/AutomationTest.h"
+#include "BpVariantBlackboard.h"
+#include "BpVariant_Generated.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "Tasks/Task.h"
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(BpVariantBlackboardTests, "Tests.BpVariantBlackboardTests",
+                                  EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool TestBlackboardValues(FAutomationTestBase* Context)
+{
+	Context->AddExpectedError(TEXT("keys can't be None"), EAutomationExpectedErrorFlags::Contains, 1);
+
+	FBpVariantBlackboard blackboard(16);
+	const bool setCorrect = blackboard.Set(TEXT("Health"), 100) && blackboard.Set(TEXT("Name"), FString(TEXT("A"))) &&
+		!blackboard.Set(NAME_None, 1);
+
+	const uint64 firstVersion = blackboard.GetVersion(TEXT("Health"));
+	blackboard.Set(TEXT("Health"), 50);
+	const bool valueCorrect = blackboard.Get<int32>(TEXT("Health")).Get(0) == 50 &&
+		blackboard.Get<FString>(TEXT("Name")).Get(FString()) == TEXT("A") &&
+		!blackboard.Get<float>(TEXT("Health")).IsSet() && !blackboard.Get<int32>(TEXT("Missing")).IsSet();
+	const bool versionCorrect = firstVersion != 0 && blackboard.GetVersion(TEXT("Health")) > firstVersion &&
+		blackboard.GetVersion(TEXT("Missing")) == 0;
+
+	Context->TestTrue(TEXT("Named keys should be written and None rejected"), setCorrect);
+	Context->TestTrue(TEXT("Reads should return the latest value of the requested type"), valueCorrect);
+	Context->TestTrue(TEXT("Writes should raise the version of the key"), versionCorrect);
+
+	return setCorrect && valueCorrect && versionCorrect;
+}
+
+bool TestBlackboardIsFull(FAutomationTestBase* Context)
+{
+	Context->AddExpectedError(TEXT("blackboard is full"), EAutomationExpectedErrorFlags::Contains, 1);
+
+	FBpVariantBlackboard blackboard(2);
+	const bool fullCorrect = blackboard.Set(TEXT("A"), 1) && blackboard.Set(TEXT("B"), 2) &&
+		!blackboard.Set(TEXT("C"), 3) && blackboard.Set(TEXT("A"), 4) && blackboard.GetKeys().Num() == 2;
+
+	Context->TestTrue(TEXT("Only new keys past the limit should be rejected"), fullCorrect);
+
+	return fullCorrect;
+}
+
+bool TestConcurrentWrites(FAutomationTestBase* Context)
+{
+	constexpr int32 numKeys = 8;
+	constexpr int32 numWrites = 2000;
+	FBpVariantBlackboard blackboard(numKeys);
+
+	// Half of the workers write increasing values while the other half check that they never go backward
+	std::atomic<bool> bTornRead = false;
+	ParallelFor(8, [&blackboard, &bTornRead](const int32 Worker)
+	{
+		const FName key(TEXT("Key"), Worker / 2 % numKeys);
+		if (Worker % 2 == 0)
+		{
+			for (int32 i = 1; i <= numWrites; ++i)
+			{
+				blackboard.Set(key, FVector(i, i, i));
+			}
+			return;
+		}
+
+		double last = 0;
+		for (int32 i = 0; i < numWrites; ++i)
+		{
+			const FVector value = blackboard.Get<FVector>(key).Get(FVector::ZeroVector);
+			if (value.X != value.Y || value.X != value.Z || value.X < last)
+			{
+				bTornRead = true;
+			}
+			last = value.X;
+		}
+	});
+
+	TArray<FName> changedKeys;
+	blackboard.Flush(changedKeys);
+	blackboard.Flush(changedKeys);
+
+	const bool readsCorrect = !bTornRead;
+	const bool valuesCorrect = blackboard.Get<FVector>(FName(TEXT("Key"), 0)).Get(FVector::ZeroVector).X == numWrites &&
+		blackboard.Get<FVector>(FName(TEXT("Key"), 3)).Get(FVector::ZeroVector).X == numWrites;
+
+	Context->TestTrue(TEXT("Readers should only see whole values, in order"), readsCorrect);
+	Context->TestTrue(TEXT("Every key should end on its last write"), valuesCorrect);
+
+	return readsCorrect && valuesCorrect;
+}
+
+bool TestConcurrentStringHashes(FAutomationTestBase* Context)
+{
+	constexpr int32 numKeys = 4;
+	constexpr int32 numWrites = 2000;
+	FBpVariantBlackboard blackboard(numKeys);
+
+	// One worker per key writes strings while two others hash the same snapshots in place and through copies
+	std::atomic<bool> bBadHash = false;
+	ParallelFor(numKeys * 3, [&blackboard, &bBadHash](const int32 Worker)
+	{
+		const FName key(TEXT("Key"), Worker / 3);
+		if (Worker % 3 == 0)
+		{
+			for (int32 i = 1; i <= numWrites; ++i)
+			{
+				blackboard.Set(key, FString::Printf(TEXT("Value%d"), i));
+			}
+			return;
+		}
+
+		for (int32 i = 0; i < numWrites; ++i)
+		{
+			blackboard.Read(key, [&bBadHash](const FBpVariant& Value)
+			{
+				const FString string = UBpVariantStatics::GetString(Value);
+				if (GetTypeHash(Value) != GetTypeHash(UBpVariantStatics::MakeVariantFromString(string)))
+				{
+					bBadHash = true;
+				}
+			});
+
+			FBpVariant copy;
+			if (blackboard.TryGetValue(key, copy))
+			{
+				const FString string = UBpVariantStatics::GetString(copy);
+				const FBpVariant expected = UBpVariantStatics::MakeVariantFromString(string);
+				if (GetTypeHash(copy) != GetTypeHash(expected))
+				{
+					bBadHash = true;
+				}
+			}
+		}
+	});
+
+	TArray<FName> changedKeys;
+	blackboard.Flush(changedKeys);
+	blackboard.Flush(changedKeys);
+
+	const bool hashCorrect = !bBadHash;
+	const bool valueCorrect = blackboard.Get<FString>(FName(TEXT("Key"), 1)).Get(FString()) ==
+		FString::Printf(TEXT("Value%d"), numWrites);
+
+	Context->TestTrue(TEXT("Hashing a shared value from many threads should match a fresh variant"), hashCorrect);
+	Context->TestTrue(TEXT("Every key should end on its last string"), valueCorrect);
+
+	return hashCorrect && valueCorrect;
+}
+
+bool TestChangesAreBatched(FAutomationTestBase* Context)
+{
+	FBpVariantBlackboard blackboard(16);
+	blackboard.Set(TEXT("A"), 1);
+	blackboard.Set(TEXT("A"), 2);
+	blackboard.Set(TEXT("B"), 3);
+
+	TArray<FName> changedKeys;
+	blackboard.Flush(changedKeys);
+	const bool batchCorrect = changedKeys.Num() == 2 && changedKeys.Contains(TEXT("A")) &&
+		changedKeys.Contains(TEXT("B"));
+
+	blackboard.Flush(changedKeys);
+	const bool emptyCorrect = changedKeys.IsEmpty();
+
+	blackboard.Set(TEXT("B"), 4);
+	blackboard.Flush(changedKeys);
+	const bool againCorrect = changedKeys.Num() == 1 && changedKeys[0] == TEXT("B");
+
+	Context->TestTrue(TEXT("Each changed key should be reported once per flush"), batchCorrect);
+	Context->TestTrue(TEXT("Nothing should be reported without writes"), emptyCorrect);
+	Context->TestTrue(TEXT("A key should be reported again after its next write"), againCorrect);
+
+	return batchCorrect && emptyCorrect && againCorrect;
+}
+
+bool TestObjectsOnlyFromGameThread(FAutomationTestBase* Context)
+{
+	Context->AddExpectedError(TEXT("can only be written to the variant blackboard from the game thread"),
+	                          EAutomationExpectedErrorFlags::Contains, 1);
+
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false);
+	UBpVariantBlackboardSubsystem* subsystem = UBpVariantBlackboardSubsystem::Get(world);
+	TSharedRef<FBpVariantBlackboard, ESPMode::ThreadSafe> blackboard = subsystem->GetBlackboard();
+
+	const bool bWorkerWrote = UE::Tasks::Launch(UE_SOURCE_LOCATION, [blackboard]()
+	{
+		return blackboard->Set(TEXT("Object"), static_cast<UObject*>(GetTransientPackage()));
+	}).GetResult();
+	const bool bGameThreadWrote = subsystem->SetBlackboardValue(TEXT("Object"),
+	                                                            UBpVariantStatics::MakeVariantFromObject(world));
+
+	FBpVariant value;
+	const bool threadCorrect = !bWorkerWrote && bGameThreadWrote &&
+		subsystem->GetBlackboardValue(TEXT("Object"), value) && UBpVariantStatics::GetObject(value) == world;
+
+	world->DestroyWorld(false);
+
+	Context->TestTrue(TEXT("Objects should only be written from the game thread"), threadCorrect);
+
+	return threadCorrect;
+}
+
+const FString BpVariantBlackboardTests_Values = TEXT("BpVariantBlackboardTests_Values");
+const FString BpVariantBlackboardTests_IsFull = TEXT("BpVariantBlackboardTests_IsFull");
+const FString BpVariantBlackboardTests_ConcurrentWrites = TEXT("BpVariantBlackboardTests_ConcurrentWrites");
+const FString BpVariantBlackboardTests_ConcurrentStringHashes = TEXT("BpVariantBlackboardTests_ConcurrentStringHashes");
+const FString BpVariantBlackboardTests_ChangesAreBatched = TEXT("BpVariantBlackboardTests_ChangesAreBatched");
+const FString BpVariantBlackboardTests_ObjectsOnlyFromGameThread =
+	TEXT("BpVariantBlackboardTests_ObjectsOnlyFromGameThread");
+
+void BpVariantBlackboardTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FString> tests =
+	{
+		BpVariantBlackboardTests_Values,
+		BpVariantBlackboardTests_IsFull,
+		BpVariantBlackboardTests_ConcurrentWrites,
+		BpVariantBlackboardTests_ConcurrentStringHashes,
+		BpVariantBlackboardTests_ChangesAreBatched,
+		BpVariantBlackboardTests_ObjectsOnlyFromGameThread,
+	};
+
+	for (const FString& test : tests)
+	{
+		OutBeautifiedNames.Add(test);
+		OutTestCommands.Add(test);
+	}
+}
+
+bool BpVariantBlackboardTests::RunTest(const FString& Parameters)
+{
+	TMap<FString, TFunction<bool()>> tests =
+	{
+		{
+			BpVariantBlackboardTests_Values,
+			[this]() { return TestBlackboardValues(this); }
+		},
+		{
+			BpVariantBlackboardTests_IsFull,
+			[this]() { return TestBlackboardIsFull(this); }
+		},
+		{
+			BpVariantBlackboardTests_ConcurrentWrites,
+			[this]() { return TestConcurrentWrites(this); }
+		},
+		{
+			BpVariantBlackboardTests_ConcurrentStringHashes,
+			[this]() { return TestConcurrentStringHashes(this); }
+		},
+		{
+			BpVariantBlackboardTests_ChangesAreBatched,
+			[this]() { return TestChangesAreBatched(this); }
+		},
+		{
+			BpVariantBlackboardTests_ObjectsOnlyFromGameThread,
+			[this]() { return TestObjectsOnlyFromGameThread(this); }
+		},
+	};
+
+	if (tests.Contains(Parameters))
+	{
+		return tests[Parameters]();
+	}
+	return true;
+}
@@ -0,0 +1,150 @@
+﻿#include "Misc/AutomationTest.h"
+#include "BpVariant_Generated.h"
+#include "TestObject.h"
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(BpVariantConversionTests, "Tests.BpVariantConversionTests",
+                                  EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool TestConversionKinds(FAutomationTestBase* Context)
+{
+	const bool losslessCorrect =
+		UBpVariantStatics::GetConversion(EValueType::Int32, EValueType::Float64) == EBpVariantConversion::Lossless &&
+		UBpVariantStatics::GetConversion(EValueType::Byte, EValueType::Int32) == EBpVariantConversion::Lossless &&
+		UBpVariantStatics::GetConversion(EValueType::Name, EValueType::String) == EBpVariantConversion::Lossless &&
+		UBpVariantStatics::GetConversion(EValueType::Class, EValueType::Object) == EBpVariantConversion::Lossless;
+	const bool lossyCorrect =
+		UBpVariantStatics::GetConversion(EValueType::Float64, EValueType::Int32) == EBpVariantConversion::Lossy &&
+		UBpVariantStatics::GetConversion(EValueType::Int32, EValueType::Float32) == EBpVariantConversion::Lossy &&
+		UBpVariantStatics::GetConversion(EValueType::String, EValueType::Name) == EBpVariantConversion::Lossy;
+	const bool rejectedCorrect =
+		UBpVariantStatics::GetConversion(EValueType::Vector, EValueType::Object) == EBpVariantConversion::Rejected &&
+		UBpVariantStatics::GetConversion(EValueType::Struct, EValueType::Int32) == EBpVariantConversion::Rejected &&
+		UBpVariantStatics::GetConversion(EValueType::None, EValueType::Int32) == EBpVariantConversion::Rejected;
+
+	Context->TestTrue(TEXT("Widening conversions should be lossless"), losslessCorrect);
+	Context->TestTrue(TEXT("Narrowing conversions should be lossy"), lossyCorrect);
+	Context->TestTrue(TEXT("Unrelated types should be rejected"), rejectedCorrect);
+
+	return losslessCorrect && lossyCorrect && rejectedCorrect;
+}
+
+bool TestScalarConversions(FAutomationTestBase* Context)
+{
+	const TOptional<double> wide = UBpVariantStatics::TryConvert<double>(UBpVariantStatics::MakeVariantFromInt(3));
+	const TOptional<FString> name = UBpVariantStatics::TryConvert<FString>(
+		UBpVariantStatics::MakeVariantFromName(TEXT("Name")));
+	const TOptional<int32> byte = UBpVariantStatics::TryConvert<int32>(UBpVariantStatics::MakeVariantFromByte(200));
+	const bool losslessCorrect = wide.Get(0.0) == 3.0 && name.Get(FString()) == TEXT("Name") && byte.Get(0) == 200;
+
+	const TOptional<int32> parsed = UBpVariantStatics::TryConvert<int32>(
+		UBpVariantStatics::MakeVariantFromString(TEXT("42")));
+	const TOptional<int32> saturated = UBpVariantStatics::TryConvert<int32>(
+		UBpVariantStatics::MakeVariantFromDouble(1e20));
+	const TOptional<uint8> clamped = UBpVariantStatics::TryConvert<uint8>(UBpVariantStatics::MakeVariantFromInt(-5));
+	const bool lossyCorrect = parsed.Get(0) == 42 && saturated.Get(0) == MAX_int32 && clamped.Get(1) == 0;
+
+	const bool failCorrect = !UBpVariantStatics::TryConvert<int32>(
+			UBpVariantStatics::MakeVariantFromString(TEXT("abc"))).IsSet() &&
+		!UBpVariantStatics::TryConvert<int32>(UBpVariantStatics::MakeVariantFromDouble(2.5), false).IsSet() &&
+		!UBpVariantStatics::TryConvert<UObject*>(UBpVariantStatics::MakeVariantFromVector(FVector::OneVector)).IsSet();
+
+	Context->TestTrue(TEXT("Lossless conversions should keep the value"), losslessCorrect);
+	Context->TestTrue(TEXT("Lossy conversions should parse and saturate"), lossyCorrect);
+	Context->TestTrue(TEXT("Unparseable, disallowed lossy and rejected conversions should fail"), failCorrect);
+
+	return losslessCorrect && lossyCorrect && failCorrect;
+}
+
+bool TestObjectConversions(FAutomationTestBase* Context)
+{
+	UTestObject* object = NewObject<UTestObject>();
+	FBpVariant result;
+	EBpVariantConversion conversion;
+
+	const bool softCorrect = UBpVariantStatics::ConvertTo(UBpVariantStatics::MakeVariantFromObject(object),
+	                                                      EValueType::SoftObject, result, conversion) &&
+		conversion == EBpVariantConversion::Lossless && UBpVariantStatics::GetSoftObject(result).Get() == object;
+	const bool classCorrect = !UBpVariantStatics::ConvertTo(UBpVariantStatics::MakeVariantFromObject(object),
+	                                                        EValueType::Class, result, conversion) &&
+		UBpVariantStatics::GetType(result) == EValueType::None;
+
+	Context->TestTrue(TEXT("Objects should convert to soft pointers to them"), softCorrect);
+	Context->TestTrue(TEXT("Objects that aren't classes should not convert to classes"), classCorrect);
+
+	return softCorrect && classCorrect;
+}
+
+bool TestArrayConversions(FAutomationTestBase* Context)
+{
+	const TArray<FBpVariant> variants =
+	{
+		UBpVariantStatics::MakeVariantFromInt(1),
+		UBpVariantStatics::MakeVariantFromFloat(2.5f),
+		UBpVariantStatics::MakeVariantFromString(TEXT("3.5")),
+		UBpVariantStatics::MakeVariantFromVector(FVector::ZeroVector),
+	};
+
+	TArray<FBpVariant> results;
+	const int32 numConverted = UBpVariantStatics::ConvertArrayTo(variants, EValueType::Float64, results);
+
+	const bool countCorrect = numConverted == 3 && results.Num() == 4;
+	const bool valuesCorrect = UBpVariantStatics::GetDouble(results[0]) == 1.0 &&
+		UBpVariantStatics::GetDouble(results[1]) == 2.5 && UBpVariantStatics::GetDouble(results[2]) == 3.5 &&
+		UBpVariantStatics::GetType(results[3]) == EValueType::None;
+
+	Context->TestTrue(TEXT("Every convertible element should be converted"), countCorrect);
+	Context->TestTrue(TEXT("Converted elements should hold the value, and the rest should be empty"), valuesCorrect);
+
+	return countCorrect && valuesCorrect;
+}
+
+const FString BpVariantConversionTests_Kinds = TEXT("BpVariantConversionTests_Kinds");
+const FString BpVariantConversionTests_Scalar = TEXT("BpVariantConversionTests_Scalar");
+const FString BpVariantConversionTests_Objects = TEXT("BpVariantConversionTests_Objects");
+const FString BpVariantConversionTests_Arrays = TEXT("BpVariantConversionTests_Arrays");
+
+void BpVariantConversionTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FString> tests =
+	{
+		BpVariantConversionTests_Kinds,
+		BpVariantConversionTests_Scalar,
+		BpVariantConversionTests_Objects,
+		BpVariantConversionTests_Arrays,
+	};
+
+	for (const FString& test : tests)
+	{
+		OutBeautifiedNames.Add(test);
+		OutTestCommands.Add(test);
+	}
+}
+
+bool BpVariantConversionTests::RunTest(const FString& Parameters)
+{
+	TMap<FString, TFunction<bool()>> tests =
+	{
+		{
+			BpVariantConversionTests_Kinds,
+			[this]() { return TestConversionKinds(this); }
+		},
+		{
+			BpVariantConversionTests_Scalar,
+			[this]() { return TestScalarConversions(this); }
+		},
+		{
+			BpVariantConversionTests_Objects,
+			[this]() { return TestObjectConversions(this); }
+		},
+		{
+			BpVariantConversionTests_Arrays,
+			[this]() { return TestArrayConversions(this); }
+		},
+	};
+
+	if (tests.Contains(Parameters))
+	{
+		return tests[Parameters]();
+	}
+	return true;
+}
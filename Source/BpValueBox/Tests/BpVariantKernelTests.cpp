@@ -0,0 +1,192 @@
+﻿#include "Misc/AutomationTest.h"
+#include "BpVariantKernels.h"
+#include "BpVariant_Generated.h"
+#include "ValueType.h"
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(BpVariantKernelTests, "Tests.BpVariantKernelTests",
+								  EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Long enough to go through the SIMD loops and leave a remainder for the scalar tail
+TArray<double> MakeKernelDoubles()
+{
+	TArray<double> values;
+	for (int32 i = 1; i <= 11; ++i)
+	{
+		values.Add(i * 0.5);
+	}
+	return values;
+}
+
+// Runs of different types with a string in the middle
+TArray<FBpVariant> MakeKernelVariants()
+{
+	TArray<FBpVariant> variants;
+	for (int32 i = 0; i < 6; ++i)
+	{
+		variants.Add(UBpVariantStatics::MakeVariantFromInt(i));
+	}
+	variants.Add(UBpVariantStatics::MakeVariantFromString(TEXT("Not a number")));
+	for (int32 i = 0; i < 5; ++i)
+	{
+		variants.Add(UBpVariantStatics::MakeVariantFromDouble(i + 0.5));
+	}
+	variants.Add(UBpVariantStatics::MakeVariantFromByte(200));
+	return variants;
+}
+
+bool TestKernelSum(FAutomationTestBase* Context)
+{
+	const bool doublesCorrect = FMath::IsNearlyEqual(
+		FBpVariantKernels::Sum(TConstArrayView<double>(MakeKernelDoubles())), 33.0);
+	// 0..5 + 0.5..4.5 + 200
+	const bool variantsCorrect = FMath::IsNearlyEqual(
+		FBpVariantKernels::Sum(TConstArrayView<FBpVariant>(MakeKernelVariants())), 15.0 + 12.5 + 200.0);
+
+	Context->TestTrue(TEXT("Sum of doubles should match"), doublesCorrect);
+	Context->TestTrue(TEXT("Sum of variants should skip values that aren't numbers"), variantsCorrect);
+
+	return doublesCorrect && variantsCorrect;
+}
+
+bool TestKernelMinMax(FAutomationTestBase* Context)
+{
+	double min = 0;
+	double max = 0;
+	const bool doublesCorrect = FBpVariantKernels::MinMax(TConstArrayView<double>(MakeKernelDoubles()), min, max) &&
+		min == 0.5 && max == 5.5;
+	const bool variantsCorrect = FBpVariantKernels::MinMax(TConstArrayView<FBpVariant>(MakeKernelVariants()), min,
+	                                                       max) && min == 0 && max == 200;
+	const bool emptyCorrect = !FBpVariantKernels::MinMax(TConstArrayView<double>(), min, max);
+
+	Context->TestTrue(TEXT("Min and max of doubles should match"), doublesCorrect);
+	Context->TestTrue(TEXT("Min and max of variants should match"), variantsCorrect);
+	Context->TestTrue(TEXT("Min and max of nothing should fail"), emptyCorrect);
+
+	return doublesCorrect && variantsCorrect && emptyCorrect;
+}
+
+bool TestKernelScale(FAutomationTestBase* Context)
+{
+	TArray<FBpVariant> variants = MakeKernelVariants();
+	FBpVariantKernels::Scale(TArrayView<FBpVariant>(variants), 2);
+
+	const bool intCorrect = UBpVariantStatics::GetInt(variants[5]) == 10;
+	const bool doubleCorrect = UBpVariantStatics::GetDouble(variants[8]) == 3.0;
+	const bool byteCorrect = UBpVariantStatics::GetByte(variants.Last()) == 255;
+	const bool typesCorrect = UBpVariantStatics::GetType(variants[5]) == EValueType::Int32 &&
+		UBpVariantStatics::GetType(variants[6]) == EValueType::String;
+
+	Context->TestTrue(TEXT("Scaled ints should stay ints"), intCorrect && typesCorrect);
+	Context->TestTrue(TEXT("Scaled doubles should match"), doubleCorrect);
+	Context->TestTrue(TEXT("Scaled bytes should clamp"), byteCorrect);
+
+	return intCorrect && doubleCorrect && byteCorrect && typesCorrect;
+}
+
+bool TestKernelScaleSaturates(FAutomationTestBase* Context)
+{
+	TArray<FBpVariant> variants =
+	{
+		UBpVariantStatics::MakeVariantFromInt64(MAX_int64),
+		UBpVariantStatics::MakeVariantFromInt64(MIN_int64),
+		UBpVariantStatics::MakeVariantFromInt(MAX_int32),
+	};
+	FBpVariantKernels::Scale(TArrayView<FBpVariant>(variants), 4);
+	const bool overflowCorrect = UBpVariantStatics::GetInt64(variants[0]) == MAX_int64 &&
+		UBpVariantStatics::GetInt64(variants[1]) == MIN_int64 && UBpVariantStatics::GetInt(variants[2]) == MAX_int32;
+
+	// MAX_int64 is 2^63 as a double, so halving it lands on 2^62
+	FBpVariantKernels::Scale(TArrayView<FBpVariant>(variants), 0.5);
+	const bool halfCorrect = UBpVariantStatics::GetInt64(variants[0]) == MAX_int64 / 2 + 1 &&
+		UBpVariantStatics::GetInt64(variants[1]) == MIN_int64 / 2;
+
+	FBpVariantKernels::Scale(TArrayView<FBpVariant>(variants), std::numeric_limits<double>::quiet_NaN());
+	const bool nanCorrect = UBpVariantStatics::GetInt64(variants[0]) == 0 &&
+		UBpVariantStatics::GetInt64(variants[1]) == 0 && UBpVariantStatics::GetInt(variants[2]) == 0;
+
+	Context->TestTrue(TEXT("Scaled integers should saturate at their limits"), overflowCorrect);
+	Context->TestTrue(TEXT("Saturated integers should scale back down"), halfCorrect);
+	Context->TestTrue(TEXT("Scaling integers by NaN should give 0"), nanCorrect);
+
+	return overflowCorrect && halfCorrect && nanCorrect;
+}
+
+bool TestKernelLerpAndCompare(FAutomationTestBase* Context)
+{
+	const TArray<double> values = MakeKernelDoubles();
+	const TArray<double> lerped = UBpVariantKernelStatics::LerpDoubles(values, TArray<double>(), 0.5);
+	const bool emptyCorrect = lerped.IsEmpty();
+
+	TArray<double> zeros;
+	zeros.SetNumZeroed(values.Num());
+	const TArray<double> half = UBpVariantKernelStatics::LerpDoubles(zeros, values, 0.5);
+	const bool lerpCorrect = half.Num() == values.Num() && half[10] == values[10] * 0.5;
+
+	const TArray<bool> greater = UBpVariantKernelStatics::CompareVariantsToScalar(
+		MakeKernelVariants(), 3, EBpVariantComparison::Greater);
+	const bool compareCorrect = greater.Num() == 13 && !greater[3] && greater[4] && !greater[6] && greater[10] &&
+		greater[12];
+
+	Context->TestTrue(TEXT("Lerp should only cover values in both arrays"), emptyCorrect);
+	Context->TestTrue(TEXT("Lerp should match"), lerpCorrect);
+	Context->TestTrue(TEXT("Compare should match, failing for values that aren't numbers"), compareCorrect);
+
+	return emptyCorrect && lerpCorrect && compareCorrect;
+}
+
+const FString BpVariantKernelTests_Sum = TEXT("BpVariantKernelTests_Sum");
+const FString BpVariantKernelTests_MinMax = TEXT("BpVariantKernelTests_MinMax");
+const FString BpVariantKernelTests_Scale = TEXT("BpVariantKernelTests_Scale");
+const FString BpVariantKernelTests_ScaleSaturates = TEXT("BpVariantKernelTests_ScaleSaturates");
+const FString BpVariantKernelTests_LerpAndCompare = TEXT("BpVariantKernelTests_LerpAndCompare");
+
+void BpVariantKernelTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FString> tests =
+	{
+		BpVariantKernelTests_Sum,
+		BpVariantKernelTests_MinMax,
+		BpVariantKernelTests_Scale,
+		BpVariantKernelTests_ScaleSaturates,
+		BpVariantKernelTests_LerpAndCompare,
+	};
+
+	for (const FString& test : tests)
+	{
+		OutBeautifiedNames.Add(test);
+		OutTestCommands.Add(test);
+	}
+}
+
+bool BpVariantKernelTests::RunTest(const FString& Parameters)
+{
+	TMap<FString, TFunction<bool()>> tests =
+	{
+		{
+			BpVariantKernelTests_Sum,
+			[this]() { return TestKernelSum(this); }
+		},
+		{
+			BpVariantKernelTests_MinMax,
+			[this]() { return TestKernelMinMax(this); }
+		},
+		{
+			BpVariantKernelTests_Scale,
+			[this]() { return TestKernelScale(this); }
+		},
+		{
+			BpVariantKernelTests_ScaleSaturates,
+			[this]() { return TestKernelScaleSaturates(this); }
+		},
+		{
+			BpVariantKernelTests_LerpAndCompare,
+			[this]() { return TestKernelLerpAndCompare(this); }
+		},
+	};
+
+	if (tests.Contains(Parameters))
+	{
+		return tests[Parameters]();
+	}
+	return true;
+}
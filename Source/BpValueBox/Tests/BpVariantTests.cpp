@@ -1,7 +1,10 @@
 ﻿#include "Misc/AutomationTest.h"
-#include "BpVariant.h"
+#include "BpVariant_Generated.h"
 #include "ValueType.h"
 #include "TestObject.h"
+#include "BoxedValue.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
 IMPLEMENT_COMPLEX_AUTOMATION_TEST(BpVariantTests, "Tests.BpVariantTests",
 								  EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
@@ -79,6 +82,20 @@ bool TestObjectVariant(FAutomationTestBase* Context, UObject* Input)
 	return typeCorrect && valueCorrect;
 }
 
+bool TestClassVariant(FAutomationTestBase* Context, UClass* Input)
+{
+	const FBpVariant value = UBpVariantStatics::MakeVariantFromClass(Input);
+	const UClass* actual = UBpVariantStatics::GetClass(value);
+
+	const bool typeCorrect = UBpVariantStatics::GetType(value) == EValueType::Class;
+	const bool valueCorrect = actual == Input;
+
+	Context->TestTrue(TEXT("Variant type should be expected type"), typeCorrect);
+	Context->TestTrue(TEXT("Variant value should match the original value"), valueCorrect);
+
+	return typeCorrect && valueCorrect;
+}
+
 bool TestVariantCanBeChanged(FAutomationTestBase* Context)
 {
 	const FVariant input1 = true;
@@ -111,6 +128,373 @@ bool TestVariantCanBeChanged(FAutomationTestBase* Context)
 		copyValueCorrect;
 }
 
+bool TestTryGetReadsInPlace(FAutomationTestBase* Context)
+{
+	const FString input = FGuid::NewGuid().ToString();
+	const FBpVariant value = UBpVariantStatics::MakeVariantFromString(input);
+
+	const FString* actual = UBpVariantStatics::TryGetString(value);
+
+	const bool pointerCorrect = actual == &value.Data.Get<FString>();
+	const bool viewCorrect = UBpVariantStatics::GetStringView(value) == input;
+	const bool mismatchCorrect = UBpVariantStatics::TryGetStruct(value) == nullptr &&
+		UBpVariantStatics::GetStringView(UBpVariantStatics::MakeVariantFromInt(1)).IsEmpty();
+
+	Context->TestTrue(TEXT("TryGet should point at the value stored in the variant"), pointerCorrect);
+	Context->TestTrue(TEXT("String view should match the original value"), viewCorrect);
+	Context->TestTrue(TEXT("TryGet of another type should return nothing"), mismatchCorrect);
+
+	return pointerCorrect && viewCorrect && mismatchCorrect;
+}
+
+bool TestTypeFollowsData(FAutomationTestBase* Context)
+{
+	// Data is written directly here, skipping the setters
+	FBpVariant variant = UBpVariantStatics::MakeVariantFromInt(1);
+	variant.Data.Set<FString>(TEXT("Written"));
+	const bool stringCorrect = UBpVariantStatics::GetType(variant) == EValueType::String &&
+		UBpVariantStatics::GetString(variant) == TEXT("Written");
+
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	variant.Serialize(writer);
+	FBpVariant loaded;
+	FMemoryReader reader(bytes);
+	loaded.Serialize(reader);
+	const bool loadCorrect = !reader.IsError() && loaded == variant;
+
+	variant.Data.Emplace<FEmptyVariantState>();
+	const bool emptyCorrect = UBpVariantStatics::GetType(variant) == EValueType::None;
+
+	Context->TestTrue(TEXT("Type should follow a value written straight into Data"), stringCorrect);
+	Context->TestTrue(TEXT("Variant written straight into Data should save its live type"), loadCorrect);
+	Context->TestTrue(TEXT("Emptied variant should have no type"), emptyCorrect);
+
+	return stringCorrect && loadCorrect && emptyCorrect;
+}
+
+bool TestLoadsBeforeCustomVersion(FAutomationTestBase* Context)
+{
+	// Older packages saved FBpVariant as tagged properties, which is nothing but the None that ends them
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	FName end = NAME_None;
+	writer << end;
+
+	FBpVariant loaded = UBpVariantStatics::MakeVariantFromInt(5);
+	FMemoryReader reader(bytes, true);
+	reader.SetCustomVersion(FBpVariantCustomVersion::GUID, FBpVariantCustomVersion::BeforeCustomVersionWasAdded,
+		TEXT("BpVariant"));
+	const bool fallbackCorrect = !loaded.Serialize(reader) && reader.Tell() == 0;
+
+	FBpVariant::StaticStruct()->SerializeItem(reader, &loaded, nullptr);
+	const bool loadCorrect = !reader.IsError() && reader.AtEnd();
+
+	Context->TestTrue(TEXT("Variant should leave older packages to the tagged property path"), fallbackCorrect);
+	Context->TestTrue(TEXT("Variant from an older package should load its tagged properties"), loadCorrect);
+
+	return fallbackCorrect && loadCorrect;
+}
+
+bool TestSerializeRoundTrip(FAutomationTestBase* Context, const FBpVariant& Input, const int32 ExpectedBytes)
+{
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	FBpVariant written = Input;
+	written.Serialize(writer);
+
+	FBpVariant actual;
+	FMemoryReader reader(bytes);
+	actual.Serialize(reader);
+
+	const bool typeCorrect = UBpVariantStatics::GetType(actual) == UBpVariantStatics::GetType(Input);
+	const bool valueCorrect = UBpVariantStatics::Equals(actual, Input);
+	const bool sizeCorrect = ExpectedBytes == INDEX_NONE || bytes.Num() == ExpectedBytes;
+
+	Context->TestTrue(TEXT("Loaded variant type should match the saved type"), typeCorrect);
+	Context->TestTrue(TEXT("Loaded variant value should match the saved value"), valueCorrect);
+	Context->TestTrue(TEXT("Saved variant should use the compact encoding"), sizeCorrect);
+
+	return typeCorrect && valueCorrect && sizeCorrect;
+}
+
+bool TestSerializeRoundTrips(FAutomationTestBase* Context)
+{
+	// Integers are a tag byte followed by a zigzag varint, so small values only take two bytes
+	bool bSuccess = TestSerializeRoundTrip(Context, UBpVariantStatics::MakeVariantFromInt(-1), 2);
+	bSuccess &= TestSerializeRoundTrip(Context, UBpVariantStatics::MakeVariantFromInt64(MAX_int64), 11);
+	bSuccess &= TestSerializeRoundTrip(Context, UBpVariantStatics::MakeVariantFromBool(true), 2);
+	bSuccess &= TestSerializeRoundTrip(Context, FBpVariant(), 1);
+	bSuccess &= TestSerializeRoundTrip(Context, UBpVariantStatics::MakeVariantFromString(TEXT("BpVariant")),
+	                                   INDEX_NONE);
+	bSuccess &= TestSerializeRoundTrip(Context, UBpVariantStatics::MakeVariantFromVector(FVector(1, 2, 3)),
+	                                   INDEX_NONE);
+	bSuccess &= TestSerializeRoundTrip(Context, UBpVariantStatics::MakeVariantFromStruct(
+		                                   FInstancedStruct::Make(FVector(1, 2, 3))), INDEX_NONE);
+	return bSuccess;
+}
+
+bool TestVariantKeepsObjectAlive(FAutomationTestBase* Context)
+{
+	UTestVariantHolder* holder = NewObject<UTestVariantHolder>();
+	holder->AddToRoot();
+
+	const TWeakObjectPtr<UTestObject> object = NewObject<UTestObject>();
+	const TWeakObjectPtr<UTestObject> structObject = NewObject<UTestObject>();
+	const TWeakObjectPtr<UTestObject> writtenObject = NewObject<UTestObject>();
+	holder->Variants.Add(UBpVariantStatics::MakeVariantFromObject(object.Get()));
+	holder->Variants.Add(UBpVariantStatics::MakeVariantFromStruct(
+		FInstancedStruct::Make(FTestObjectStruct{structObject.Get()})));
+	// Written straight into Data, skipping the setters
+	holder->Variants.Add(UBpVariantStatics::MakeVariantFromInt(1));
+	holder->Variants.Last().Data.Set<UObject*>(writtenObject.Get());
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+	const bool aliveCorrect = object.IsValid() && UBpVariantStatics::GetObject(holder->Variants[0]) == object.Get();
+	const FTestObjectStruct* payload = UBpVariantStatics::TryGetStructAs<FTestObjectStruct>(holder->Variants[1]);
+	const bool structAliveCorrect = structObject.IsValid() && payload && payload->Object == structObject.Get();
+	const bool writtenAliveCorrect = writtenObject.IsValid() &&
+		UBpVariantStatics::GetObject(holder->Variants[2]) == writtenObject.Get();
+
+	holder->Variants.Reset();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+	const bool collectedCorrect = !object.IsValid() && !structObject.IsValid() && !writtenObject.IsValid();
+
+	holder->RemoveFromRoot();
+
+	Context->TestTrue(TEXT("Object held by a variant should survive garbage collection"), aliveCorrect);
+	Context->TestTrue(TEXT("Object inside a variant's struct should survive garbage collection"), structAliveCorrect);
+	Context->TestTrue(TEXT("Object written straight into Data should survive garbage collection"), writtenAliveCorrect);
+	Context->TestTrue(TEXT("Objects should be collected once no variant holds them"), collectedCorrect);
+
+	return aliveCorrect && structAliveCorrect && writtenAliveCorrect && collectedCorrect;
+}
+
+bool TestHashMatchesEquality(FAutomationTestBase* Context)
+{
+	const TArray<TPair<FBpVariant, FBpVariant>> equalPairs =
+	{
+		{UBpVariantStatics::MakeVariantFromDouble(0.0), UBpVariantStatics::MakeVariantFromDouble(-0.0)},
+		{UBpVariantStatics::MakeVariantFromString(TEXT("Key")), UBpVariantStatics::MakeVariantFromString(TEXT("Key"))},
+		{UBpVariantStatics::MakeVariantFromText(FText::FromString(TEXT("Key"))),
+		 UBpVariantStatics::MakeVariantFromText(FText::AsCultureInvariant(TEXT("Key")))},
+		{UBpVariantStatics::MakeVariantFromClass(UTestObject::StaticClass()),
+		 UBpVariantStatics::MakeVariantFromClass(UTestObject::StaticClass())},
+		{UBpVariantStatics::MakeVariantFromStruct(FInstancedStruct::Make(FVector(1, 2, 3))),
+		 UBpVariantStatics::MakeVariantFromStruct(FInstancedStruct::Make(FVector(1, 2, 3)))},
+		{FBpVariant(), FBpVariant()},
+	};
+
+	bool equalCorrect = true;
+	for (const TPair<FBpVariant, FBpVariant>& pair : equalPairs)
+	{
+		equalCorrect &= pair.Key == pair.Value && GetTypeHash(pair.Key) == GetTypeHash(pair.Value);
+	}
+
+	const bool caseCorrect = UBpVariantStatics::MakeVariantFromString(TEXT("Key")) !=
+		UBpVariantStatics::MakeVariantFromString(TEXT("key")) &&
+		UBpVariantStatics::MakeVariantFromText(FText::FromString(TEXT("Key"))) !=
+		UBpVariantStatics::MakeVariantFromText(FText::FromString(TEXT("key")));
+	const bool typeCorrect = UBpVariantStatics::MakeVariantFromInt(1) != UBpVariantStatics::MakeVariantFromInt64(1);
+
+	Context->TestTrue(TEXT("Equal variants should have equal hashes"), equalCorrect);
+	Context->TestTrue(TEXT("Strings and texts should compare with case"), caseCorrect);
+	Context->TestTrue(TEXT("Variants of different types should not be equal"), typeCorrect);
+
+	return equalCorrect && caseCorrect && typeCorrect;
+}
+
+bool TestVariantKeysMap(FAutomationTestBase* Context)
+{
+	TMap<FBpVariant, int32> map;
+	map.Add(UBpVariantStatics::MakeVariantFromInt(1), 1);
+	map.Add(UBpVariantStatics::MakeVariantFromString(TEXT("Two")), 2);
+	map.Add(UBpVariantStatics::MakeVariantFromName(TEXT("Three")), 3);
+
+	FBpVariant changed = UBpVariantStatics::MakeVariantFromString(TEXT("Four"));
+	UBpVariantStatics::SetString(changed, TEXT("Two"));
+	FBpVariant written = UBpVariantStatics::MakeVariantFromString(TEXT("Five"));
+	written.Data.Get<FString>() = TEXT("Two");
+
+	const int32* found = map.Find(UBpVariantStatics::MakeVariantFromString(TEXT("Two")));
+	const bool findCorrect = found != nullptr && *found == 2 && map.Contains(UBpVariantStatics::MakeVariantFromInt(1));
+	const bool missingCorrect = !map.Contains(UBpVariantStatics::MakeVariantFromInt64(1));
+	const bool changedCorrect = map.Contains(changed) && map.Contains(written);
+
+	Context->TestTrue(TEXT("Map should find variant keys"), findCorrect);
+	Context->TestTrue(TEXT("Map should not find a key of another type"), missingCorrect);
+	Context->TestTrue(TEXT("Variants changed after they were made should still find their key"), changedCorrect);
+
+	return findCorrect && missingCorrect && changedCorrect;
+}
+
+static_assert(TBpVariantTraits<FString>::ValueType == EValueType::String);
+static_assert(TBpVariantTraits<FEmptyVariantState>::ArmIndex == 0);
+
+bool TestTypedRef(FAutomationTestBase* Context)
+{
+	FBpVariant variant = UBpVariantStatics::MakeVariantFromString(TEXT("Before"));
+
+	const TBpVariantRef<FString> ref(variant);
+	ref->Append(TEXT("After"));
+
+	const FBpVariant expected = UBpVariantStatics::MakeVariantFromString(TEXT("BeforeAfter"));
+	const bool refCorrect = ref.IsValid() && UBpVariantStatics::GetString(variant) == TEXT("BeforeAfter") &&
+		variant == expected && GetTypeHash(variant) == GetTypeHash(expected);
+	const bool mismatchCorrect = !TBpVariantRef<const int32>(variant).IsValid() &&
+		UBpVariantStatics::Holds<FString>(variant) && !UBpVariantStatics::Holds<FName>(variant);
+
+	int32 visited = 0;
+	const bool visitCorrect = UBpVariantStatics::VisitAs<FString>(variant, [&visited](const FString& Value)
+	{
+		visited = Value.Len();
+	}) && visited == 11 && !UBpVariantStatics::VisitAs<double>(variant, [](double) {});
+
+	Context->TestTrue(TEXT("Typed ref should change the value in place"), refCorrect);
+	Context->TestTrue(TEXT("Typed ref of another type should be invalid"), mismatchCorrect);
+	Context->TestTrue(TEXT("VisitAs should only call back for the held type"), visitCorrect);
+
+	return refCorrect && mismatchCorrect && visitCorrect;
+}
+
+bool TestVisit(FAutomationTestBase* Context)
+{
+	const FBpVariant name = UBpVariantStatics::MakeVariantFromName(TEXT("Name"));
+	const int32 length = UBpVariantStatics::Visit(name, TBpVariantOverloads
+	{
+		[](const FName& Value) { return static_cast<int32>(Value.GetStringLength()); },
+		[](const auto&) { return INDEX_NONE; },
+	});
+	const bool visitCorrect = length == 4 &&
+		UBpVariantStatics::Visit(FBpVariant(), [](const auto& Value)
+		{
+			return std::is_same_v<std::decay_t<decltype(Value)>, FEmptyVariantState>;
+		});
+
+	FBpVariant number = UBpVariantStatics::MakeVariantFromDouble(2.0);
+	UBpVariantStatics::Visit(number, TBpVariantOverloads
+	{
+		[](double& Value) { Value *= 2; },
+		[](auto&) {},
+	});
+	const bool mutateCorrect = UBpVariantStatics::GetDouble(number) == 4.0 &&
+		UBpVariantStatics::GetType(number) == EValueType::Float64;
+
+	Context->TestTrue(TEXT("Visit should call the overload for the held type"), visitCorrect);
+	Context->TestTrue(TEXT("Visit should be able to change the value in place"), mutateCorrect);
+
+	return visitCorrect && mutateCorrect;
+}
+
+bool TestSwitchOnVariantType(FAutomationTestBase* Context)
+{
+	EValueType type;
+	bool boolValue;
+	uint8 byteValue;
+	int32 intValue;
+	int64 int64Value;
+	float floatValue;
+	double doubleValue;
+	FName nameValue;
+	FString stringValue;
+	FText textValue;
+	FVector vectorValue;
+	FRotator rotatorValue;
+	FTransform transformValue;
+	FInstancedStruct structValue;
+	UObject* objectValue = nullptr;
+	UClass* classValue = nullptr;
+	TSoftObjectPtr<UObject> softObjectValue;
+	TSoftClassPtr<UObject> softClassValue;
+
+	UBpVariantStatics::SwitchOnVariantType(UBpVariantStatics::MakeVariantFromClass(UTestObject::StaticClass()), type,
+	                                       boolValue, byteValue, intValue, int64Value, floatValue, doubleValue,
+	                                       nameValue, stringValue, textValue, vectorValue, rotatorValue,
+	                                       transformValue, structValue, objectValue, classValue, softObjectValue,
+	                                       softClassValue);
+
+	const bool switchCorrect = type == EValueType::Class && classValue == UTestObject::StaticClass() &&
+		objectValue == nullptr;
+
+	Context->TestTrue(TEXT("Switch should output the class through the class pin only"), switchCorrect);
+
+	return switchCorrect;
+}
+
+bool TestMoveAndEmplace(FAutomationTestBase* Context)
+{
+	FBpVariant variant;
+	FString source = FGuid::NewGuid().ToString();
+	const TCHAR* buffer = *source;
+	UBpVariantStatics::Assign(variant, MoveTemp(source));
+	const bool moveCorrect = UBpVariantStatics::GetType(variant) == EValueType::String &&
+		**UBpVariantStatics::TryGetString(variant) == buffer;
+
+	FVector& vector = UBpVariantStatics::Emplace<FVector>(variant, 1.0, 2.0, 3.0);
+	vector.Z = 4.0;
+	const bool emplaceCorrect = UBpVariantStatics::GetVector(variant) == FVector(1.0, 2.0, 4.0);
+
+	FTestLargeStruct::NumCopies = 0;
+	UBpVariantStatics::EmplaceStruct<FTestLargeStruct>(variant, 7).Values[0] = 1;
+	const FTestLargeStruct* large = UBpVariantStatics::TryGetStructAs<FTestLargeStruct>(variant);
+	const bool structCorrect = large != nullptr && large->Values[0] == 1 && large->Values[511] == 7 &&
+		FTestLargeStruct::NumCopies == 0;
+
+	Context->TestTrue(TEXT("Moving a string in should keep its buffer"), moveCorrect);
+	Context->TestTrue(TEXT("Emplace should construct the value in place"), emplaceCorrect);
+	Context->TestTrue(TEXT("EmplaceStruct should not copy the struct"), structCorrect);
+
+	return moveCorrect && emplaceCorrect && structCorrect;
+}
+
+bool TestAccessModes(FAutomationTestBase* Context)
+{
+	const FBpVariant number = UBpVariantStatics::MakeVariantFromInt(5);
+	const uint32 mismatches = UBpVariantStatics::GetNumTypeMismatches();
+
+	const bool checkedCorrect = UBpVariantStatics::GetChecked<int32>(number).Get(0) == 5 &&
+		!UBpVariantStatics::GetChecked<int64>(number).IsSet();
+	const bool objectCorrect = UBpVariantStatics::GetObject(number) == nullptr;
+	const bool countCorrect = UBpVariantStatics::GetNumTypeMismatches() == mismatches + 2;
+	const bool uncheckedCorrect = UBpVariantStatics::GetAs<int32, EBpVariantAccess::Unchecked>(number) == 5 &&
+		&UBpVariantStatics::GetUnchecked<int32>(number) == &number.Data.Get<int32>();
+
+	// Blueprint getters ignore an unchecked default, so a wrong type in a graph can't become a raw load
+	UBpValueBoxSettings* settings = GetMutableDefault<UBpValueBoxSettings>();
+	const EBpVariantAccess defaultAccess = settings->DefaultAccess;
+	settings->DefaultAccess = EBpVariantAccess::Unchecked;
+	const bool blueprintCorrect = UBpVariantStatics::GetObject(number) == nullptr &&
+		UBpVariantStatics::GetStringArray({number}) == TArray<FString>({FString()}) &&
+		UBpVariantStatics::GetNumTypeMismatches() == mismatches + 4;
+	settings->DefaultAccess = defaultAccess;
+
+	Context->TestTrue(TEXT("Checked access should only return the held type"), checkedCorrect);
+	Context->TestTrue(TEXT("Getting an object from another type should return nullptr"), objectCorrect);
+	Context->TestTrue(TEXT("Checked mismatches should be counted"), countCorrect);
+	Context->TestTrue(TEXT("Unchecked access should read the value in place"), uncheckedCorrect);
+	Context->TestTrue(TEXT("Blueprint getters should stay checked when the default is unchecked"), blueprintCorrect);
+
+	return checkedCorrect && objectCorrect && countCorrect && uncheckedCorrect && blueprintCorrect;
+}
+
+bool TestVariantBoxArray(FAutomationTestBase* Context)
+{
+	TArray<FBpVariant> variants = UBpVariantStatics::MakeVariantArrayFromDouble({1.0, 2.5, -3.0});
+	const bool boxCorrect = variants.Num() == 3 && UBpVariantStatics::GetDouble(variants[1]) == 2.5 &&
+		UBpVariantStatics::GetType(variants[2]) == EValueType::Float64;
+
+	variants.Add(UBpVariantStatics::MakeVariantFromString(TEXT("Not a double")));
+	TArray<double> values;
+	const int32 numHeld = UBpVariantStatics::UnboxArray<double>(variants, values);
+	const bool unboxCorrect = numHeld == 3 && values == TArray<double>({1.0, 2.5, -3.0, 0.0});
+
+	Context->TestTrue(TEXT("Every value should get its own variant"), boxCorrect);
+	Context->TestTrue(TEXT("Unboxing should keep the order and default other types"), unboxCorrect);
+
+	return boxCorrect && unboxCorrect;
+}
+
 const FString BpVariantTests_Bool = TEXT("BpVariantTests_Bool");
 const FString BpVariantTests_Byte = TEXT("BpVariantTests_Byte");
 const FString BpVariantTests_Int32 = TEXT("BpVariantTests_Int32");
@@ -125,7 +509,22 @@ const FString BpVariantTests_Rotator = TEXT("BpVariantTests_Rotator");
 const FString BpVariantTests_Transform = TEXT("BpVariantTests_Transform");
 const FString BpVariantTests_Struct = TEXT("BpVariantTests_Struct");
 const FString BpVariantTests_Object = TEXT("BpVariantTests_Object");
+const FString BpVariantTests_Class = TEXT("BpVariantTests_Class");
+const FString BpVariantTests_Empty = TEXT("BpVariantTests_Empty");
 const FString BpVariantTests_VariantCanBeChanged = TEXT("BpVariantTests_VariantCanBeChanged");
+const FString BpVariantTests_TryGetReadsInPlace = TEXT("BpVariantTests_TryGetReadsInPlace");
+const FString BpVariantTests_TypeFollowsData = TEXT("BpVariantTests_TypeFollowsData");
+const FString BpVariantTests_LoadsBeforeCustomVersion = TEXT("BpVariantTests_LoadsBeforeCustomVersion");
+const FString BpVariantTests_SerializeRoundTrips = TEXT("BpVariantTests_SerializeRoundTrips");
+const FString BpVariantTests_VariantKeepsObjectAlive = TEXT("BpVariantTests_VariantKeepsObjectAlive");
+const FString BpVariantTests_HashMatchesEquality = TEXT("BpVariantTests_HashMatchesEquality");
+const FString BpVariantTests_VariantKeysMap = TEXT("BpVariantTests_VariantKeysMap");
+const FString BpVariantTests_TypedRef = TEXT("BpVariantTests_TypedRef");
+const FString BpVariantTests_Visit = TEXT("BpVariantTests_Visit");
+const FString BpVariantTests_SwitchOnVariantType = TEXT("BpVariantTests_SwitchOnVariantType");
+const FString BpVariantTests_MoveAndEmplace = TEXT("BpVariantTests_MoveAndEmplace");
+const FString BpVariantTests_AccessModes = TEXT("BpVariantTests_AccessModes");
+const FString BpVariantTests_BoxArray = TEXT("BpVariantTests_BoxArray");
 
 void BpVariantTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
 {
@@ -145,7 +544,22 @@ void BpVariantTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FStrin
 		BpVariantTests_Transform,
 		BpVariantTests_Struct,
 		BpVariantTests_Object,
+		BpVariantTests_Class,
+		BpVariantTests_Empty,
 		BpVariantTests_VariantCanBeChanged,
+		BpVariantTests_TryGetReadsInPlace,
+		BpVariantTests_TypeFollowsData,
+		BpVariantTests_LoadsBeforeCustomVersion,
+		BpVariantTests_SerializeRoundTrips,
+		BpVariantTests_VariantKeepsObjectAlive,
+		BpVariantTests_HashMatchesEquality,
+		BpVariantTests_VariantKeysMap,
+		BpVariantTests_TypedRef,
+		BpVariantTests_Visit,
+		BpVariantTests_SwitchOnVariantType,
+		BpVariantTests_MoveAndEmplace,
+		BpVariantTests_AccessModes,
+		BpVariantTests_BoxArray,
 	};
 
 	for (const FString& test : tests)
@@ -215,10 +629,74 @@ bool BpVariantTests::RunTest(const FString& Parameters)
 			BpVariantTests_Object,
 			[this]() { return TestObjectVariant(this, NewObject<UTestObject>()); }
 		},
+		{
+			BpVariantTests_Class,
+			[this]() { return TestClassVariant(this, UTestObject::StaticClass()); }
+		},
+		{
+			BpVariantTests_Empty,
+			[this]()
+			{
+				return TestTrue(TEXT("Default variant type should be None"),
+				                UBpVariantStatics::GetType(FBpVariant()) == EValueType::None);
+			}
+		},
 		{
 			BpVariantTests_VariantCanBeChanged,
 			[this]() { return TestVariantCanBeChanged(this); }
 		},
+		{
+			BpVariantTests_TryGetReadsInPlace,
+			[this]() { return TestTryGetReadsInPlace(this); }
+		},
+		{
+			BpVariantTests_TypeFollowsData,
+			[this]() { return TestTypeFollowsData(this); }
+		},
+		{
+			BpVariantTests_LoadsBeforeCustomVersion,
+			[this]() { return TestLoadsBeforeCustomVersion(this); }
+		},
+		{
+			BpVariantTests_SerializeRoundTrips,
+			[this]() { return TestSerializeRoundTrips(this); }
+		},
+		{
+			BpVariantTests_VariantKeepsObjectAlive,
+			[this]() { return TestVariantKeepsObjectAlive(this); }
+		},
+		{
+			BpVariantTests_HashMatchesEquality,
+			[this]() { return TestHashMatchesEquality(this); }
+		},
+		{
+			BpVariantTests_VariantKeysMap,
+			[this]() { return TestVariantKeysMap(this); }
+		},
+		{
+			BpVariantTests_TypedRef,
+			[this]() { return TestTypedRef(this); }
+		},
+		{
+			BpVariantTests_Visit,
+			[this]() { return TestVisit(this); }
+		},
+		{
+			BpVariantTests_SwitchOnVariantType,
+			[this]() { return TestSwitchOnVariantType(this); }
+		},
+		{
+			BpVariantTests_MoveAndEmplace,
+			[this]() { return TestMoveAndEmplace(this); }
+		},
+		{
+			BpVariantTests_AccessModes,
+			[this]() { return TestAccessModes(this); }
+		},
+		{
+			BpVariantTests_BoxArray,
+			[this]() { return TestVariantBoxArray(this); }
+		},
 	};
 
 	if (tests.Contains(Parameters))
@@ -0,0 +1,369 @@
+﻿#include "Misc/AutomationTest.h"
+#include "BpVariantTree.h"
+#include "BpVariant_Generated.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "TestObject.h"
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(BpVariantTreeTests, "Tests.BpVariantTreeTests",
+								  EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/* Writes straight into the storage, to make the trees only a corrupt save could load. */
+struct FCorruptibleVariantObject : public FBpVariantObject
+{
+	void SetChild(const int32 Object, const FName Key, const int32 Child)
+	{
+		Slots[FindSlot(Object, Key)].Node = Child;
+	}
+
+	void AddToUsed(const int32 Object, const int32 Count)
+	{
+		Nodes[Object].Used += Count;
+	}
+};
+
+bool TestPathParsing(FAutomationTestBase* Context)
+{
+	const FBpVariantPath path(TEXT("a.b[3].c"));
+	const TConstArrayView<FBpVariantPathSegment> segments = path.GetSegments();
+	const bool parseCorrect = path.IsValid() && segments.Num() == 4 && segments[0].Key == TEXT("a") &&
+		segments[2].Index == 3 && segments[3].Key == TEXT("c");
+
+	const bool invalidCorrect = !FBpVariantPath(TEXT("a..b")).IsValid() && !FBpVariantPath(TEXT("a[x]")).IsValid() &&
+		!FBpVariantPath(TEXT("a[1]b")).IsValid() && !FBpVariantPath(TEXT("a.")).IsValid();
+	const bool rootCorrect = FBpVariantPath(TEXT("")).IsValid() && FBpVariantPath(TEXT("[0].a")).IsValid();
+
+	Context->TestTrue(TEXT("Path should parse into keys and indices"), parseCorrect);
+	Context->TestTrue(TEXT("Malformed paths should be invalid"), invalidCorrect);
+	Context->TestTrue(TEXT("Empty paths and paths starting with an index should be valid"), rootCorrect);
+
+	return parseCorrect && invalidCorrect && rootCorrect;
+}
+
+bool TestPathSurvivesSerialization(FAutomationTestBase* Context)
+{
+	UScriptStruct* pathStruct = FBpVariantPath::StaticStruct();
+	FBpVariantPath written(TEXT("a.b[3].c"));
+
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	FObjectAndNameAsStringProxyArchive writerProxy(writer, false);
+	pathStruct->SerializeItem(writerProxy, &written, nullptr);
+
+	FBpVariantPath loaded;
+	FMemoryReader reader(bytes);
+	FObjectAndNameAsStringProxyArchive readerProxy(reader, false);
+	pathStruct->SerializeItem(readerProxy, &loaded, nullptr);
+	const bool loadCorrect = loaded.IsValid() && loaded.ToString() == written.ToString() &&
+		loaded.GetSegments().Num() == 4 && loaded.GetSegments()[2].Index == 3;
+
+	FString text;
+	pathStruct->ExportText(text, &written, nullptr, nullptr, PPF_None, nullptr);
+	FBpVariantPath imported;
+	pathStruct->ImportText(*text, &imported, nullptr, PPF_None, GLog, pathStruct->GetName());
+	FBpVariantPath importedBare;
+	pathStruct->ImportText(TEXT("x[1]"), &importedBare, nullptr, PPF_None, GLog, pathStruct->GetName());
+	const bool textCorrect = imported.IsValid() && imported.ToString() == written.ToString() &&
+		imported.GetSegments().Num() == 4 && importedBare.IsValid() && importedBare.GetSegments().Num() == 2;
+
+	Context->TestTrue(TEXT("Loaded path should be parsed again"), loadCorrect);
+	Context->TestTrue(TEXT("Path imported from text should be parsed again"), textCorrect);
+
+	return loadCorrect && textCorrect;
+}
+
+bool TestSetAndGetAtPath(FAutomationTestBase* Context)
+{
+	FBpVariantObject object;
+	const FBpVariantPath path(TEXT("a.b[0].c"));
+	UBpVariantTreeStatics::SetValueAtPath(object, path, UBpVariantStatics::MakeVariantFromInt(3));
+	UBpVariantTreeStatics::AddValueToListAtPath(object, FBpVariantPath(TEXT("a.b")),
+	                                            UBpVariantStatics::MakeVariantFromString(TEXT("Second")));
+
+	FBpVariant value;
+	const bool getCorrect = UBpVariantTreeStatics::GetValueAtPath(object, path, value) &&
+		UBpVariantStatics::GetInt(value) == 3;
+	const bool listCorrect = UBpVariantTreeStatics::NumAtPath(object, FBpVariantPath(TEXT("a.b"))) == 2 &&
+		UBpVariantTreeStatics::GetValueAtPath(object, FBpVariantPath(TEXT("a.b[1]")), value) &&
+		UBpVariantStatics::GetString(value) == TEXT("Second");
+	const bool missingCorrect = !UBpVariantTreeStatics::GetValueAtPath(object, FBpVariantPath(TEXT("a.x")), value);
+
+	Context->TestTrue(TEXT("Value set at a path should be read back"), getCorrect);
+	Context->TestTrue(TEXT("Values added to a list should be read back by index"), listCorrect);
+	Context->TestTrue(TEXT("Missing paths should not be found"), missingCorrect);
+
+	return getCorrect && listCorrect && missingCorrect;
+}
+
+bool TestRemoveAndCompact(FAutomationTestBase* Context)
+{
+	FBpVariantObject object;
+	for (int32 i = 0; i < 100; ++i)
+	{
+		UBpVariantTreeStatics::SetValueAtPath(object, FBpVariantPath(FString::Printf(TEXT("Key%d"), i)),
+		                                      UBpVariantStatics::MakeVariantFromInt(i));
+	}
+	for (int32 i = 0; i < 100; i += 2)
+	{
+		UBpVariantTreeStatics::RemoveAtPath(object, FBpVariantPath(FString::Printf(TEXT("Key%d"), i)));
+	}
+	object.Compact();
+
+	FBpVariant value;
+	const bool keptCorrect = UBpVariantTreeStatics::GetValueAtPath(object, FBpVariantPath(TEXT("Key51")), value) &&
+		UBpVariantStatics::GetInt(value) == 51;
+	const bool removedCorrect = !UBpVariantTreeStatics::GetValueAtPath(object, FBpVariantPath(TEXT("Key50")), value);
+	const bool compactCorrect = object.GetNumNodes() == 51 &&
+		UBpVariantTreeStatics::GetKeysAtPath(object, FBpVariantPath()).Num() == 50;
+
+	Context->TestTrue(TEXT("Keys that weren't removed should still be found"), keptCorrect);
+	Context->TestTrue(TEXT("Removed keys should not be found"), removedCorrect);
+	Context->TestTrue(TEXT("Compact should drop removed nodes"), compactCorrect);
+
+	return keptCorrect && removedCorrect && compactCorrect;
+}
+
+bool TestTreeSerializeRoundTrips(FAutomationTestBase* Context)
+{
+	FBpVariantList written;
+	UBpVariantTreeStatics::SetListValueAtPath(written, FBpVariantPath(TEXT("[0].Name")),
+	                                          UBpVariantStatics::MakeVariantFromName(TEXT("First")));
+	UBpVariantTreeStatics::AddValueToList(written, UBpVariantStatics::MakeVariantFromDouble(2.5));
+
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	written.Serialize(writer);
+
+	FBpVariantList actual;
+	FMemoryReader reader(bytes);
+	actual.Serialize(reader);
+
+	FBpVariant value;
+	const bool nameCorrect = UBpVariantTreeStatics::GetListValueAtPath(actual, FBpVariantPath(TEXT("[0].Name")), value)
+		&& UBpVariantStatics::GetName(value) == TEXT("First");
+	const bool doubleCorrect = UBpVariantTreeStatics::GetListValueAtPath(actual, FBpVariantPath(TEXT("[1]")), value) &&
+		UBpVariantStatics::GetDouble(value) == 2.5;
+
+	Context->TestTrue(TEXT("Loaded tree should have the saved object"), nameCorrect);
+	Context->TestTrue(TEXT("Loaded tree should have the saved value"), doubleCorrect);
+
+	return nameCorrect && doubleCorrect;
+}
+
+bool TestTreeSavedAgainstDefaults(FAutomationTestBase* Context)
+{
+	UTestVariantHolder* written = NewObject<UTestVariantHolder>();
+	FBpVariantObject& object = written->VariantObject;
+	UBpVariantTreeStatics::SetValueAtPath(object, FBpVariantPath(TEXT("a.b")),
+	                                      UBpVariantStatics::MakeVariantFromInt(1));
+	UBpVariantTreeStatics::AddValueToListAtPath(object, FBpVariantPath(TEXT("c")),
+	                                            UBpVariantStatics::MakeVariantFromString(TEXT("Item")));
+	UBpVariantTreeStatics::SetValueAtPath(object, FBpVariantPath(TEXT("d")), UBpVariantStatics::MakeVariantFromInt(2));
+	UBpVariantTreeStatics::RemoveAtPath(object, FBpVariantPath(TEXT("d")));
+
+	// Compact moves every node, but the tree it describes is the same
+	UScriptStruct* objectStruct = FBpVariantObject::StaticStruct();
+	FBpVariantObject compacted = object;
+	compacted.Compact();
+	FBpVariantObject changed = compacted;
+	UBpVariantTreeStatics::SetValueAtPath(changed, FBpVariantPath(TEXT("a.b")),
+	                                      UBpVariantStatics::MakeVariantFromInt(3));
+	const bool identicalCorrect = objectStruct->CompareScriptStruct(&object, &compacted, 0) &&
+		!objectStruct->CompareScriptStruct(&compacted, &changed, 0) &&
+		!objectStruct->CompareScriptStruct(&object, &GetDefault<UTestVariantHolder>()->VariantObject, 0);
+
+	// Properties are only saved when they differ from the class defaults
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	FObjectAndNameAsStringProxyArchive writerProxy(writer, false);
+	written->Serialize(writerProxy);
+
+	UTestVariantHolder* loaded = NewObject<UTestVariantHolder>();
+	FMemoryReader reader(bytes);
+	FObjectAndNameAsStringProxyArchive readerProxy(reader, false);
+	loaded->Serialize(readerProxy);
+	const bool loadCorrect = !reader.IsError() && objectStruct->CompareScriptStruct(&loaded->VariantObject, &object, 0);
+
+	Context->TestTrue(TEXT("Trees should compare by what is reachable from the root"), identicalCorrect);
+	Context->TestTrue(TEXT("Tree saved against its defaults should load back"), loadCorrect);
+
+	return identicalCorrect && loadCorrect;
+}
+
+bool TestCompactDeepTree(FAutomationTestBase* Context)
+{
+	constexpr int32 depth = 50000;
+	FString deepPath;
+	deepPath.Reserve(depth * 2 + 2);
+	for (int32 i = 0; i < depth; ++i)
+	{
+		deepPath += i == 0 ? TEXT("a") : TEXT(".a");
+	}
+	deepPath += TEXT(".l");
+
+	FBpVariantObject object;
+	const FBpVariantPath listPath(deepPath);
+	for (int32 i = 0; i < 3; ++i)
+	{
+		UBpVariantTreeStatics::AddValueToListAtPath(object, listPath, UBpVariantStatics::MakeVariantFromInt(i));
+	}
+	UBpVariantTreeStatics::RemoveAtPath(object, FBpVariantPath(deepPath + TEXT("[0]")));
+	UBpVariantTreeStatics::SetValueAtPath(object, FBpVariantPath(TEXT("a.Replaced")),
+	                                      UBpVariantStatics::MakeVariantFromInt(0));
+	UBpVariantTreeStatics::SetValueAtPath(object, FBpVariantPath(TEXT("a.Replaced")),
+	                                      UBpVariantStatics::MakeVariantFromString(TEXT("Replaced")));
+	object.Compact();
+
+	FBpVariant first;
+	FBpVariant second;
+	const bool compactCorrect = UBpVariantTreeStatics::NumAtPath(object, listPath) == 2 &&
+		UBpVariantTreeStatics::GetValueAtPath(object, FBpVariantPath(deepPath + TEXT("[0]")), first) &&
+		UBpVariantTreeStatics::GetValueAtPath(object, FBpVariantPath(deepPath + TEXT("[1]")), second) &&
+		UBpVariantStatics::GetInt(first) == 1 && UBpVariantStatics::GetInt(second) == 2 &&
+		object.GetNumNodes() == depth + 5;
+
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	object.Serialize(writer);
+	FBpVariantObject loaded;
+	FMemoryReader reader(bytes);
+	loaded.Serialize(reader);
+	const bool loadCorrect = !reader.IsError() && UBpVariantTreeStatics::NumAtPath(loaded, listPath) == 2;
+
+	Context->TestTrue(TEXT("Compact should keep a deep tree and its list order"), compactCorrect);
+	Context->TestTrue(TEXT("Deep compacted tree should load"), loadCorrect);
+
+	return compactCorrect && loadCorrect;
+}
+
+bool TestCorruptTreeIsRejected(FAutomationTestBase* Context)
+{
+	const auto makeTree = [](FCorruptibleVariantObject& Tree)
+	{
+		UBpVariantTreeStatics::SetValueAtPath(Tree, FBpVariantPath(TEXT("a.b")),
+		                                      UBpVariantStatics::MakeVariantFromInt(1));
+		UBpVariantTreeStatics::SetValueAtPath(Tree, FBpVariantPath(TEXT("c")),
+		                                      UBpVariantStatics::MakeVariantFromInt(2));
+	};
+	const auto loadFails = [](FCorruptibleVariantObject& Tree)
+	{
+		TArray<uint8> bytes;
+		FMemoryWriter writer(bytes);
+		Tree.Serialize(writer);
+
+		FBpVariantObject loaded;
+		FMemoryReader reader(bytes);
+		loaded.Serialize(reader);
+		return reader.IsError() && loaded.GetNumNodes() == 1;
+	};
+
+	FCorruptibleVariantObject cycle;
+	makeTree(cycle);
+	const int32 cycleObject = cycle.Find(FBpVariantPath(TEXT("a")));
+	cycle.SetChild(cycleObject, TEXT("b"), FBpVariantTree::Root);
+
+	FCorruptibleVariantObject shared;
+	makeTree(shared);
+	shared.SetChild(FBpVariantTree::Root, TEXT("c"), shared.Find(FBpVariantPath(TEXT("a"))));
+
+	FCorruptibleVariantObject badSlot;
+	makeTree(badSlot);
+	badSlot.SetChild(FBpVariantTree::Root, TEXT("c"), -5);
+
+	FCorruptibleVariantObject badCount;
+	makeTree(badCount);
+	badCount.AddToUsed(FBpVariantTree::Root, 1);
+
+	FCorruptibleVariantObject intact;
+	makeTree(intact);
+
+	const bool cycleCorrect = loadFails(cycle);
+	const bool sharedCorrect = loadFails(shared);
+	const bool slotCorrect = loadFails(badSlot);
+	const bool countCorrect = loadFails(badCount);
+	const bool intactCorrect = !loadFails(intact);
+
+	Context->TestTrue(TEXT("Tree with a cycle should not load"), cycleCorrect);
+	Context->TestTrue(TEXT("Tree with a shared child should not load"), sharedCorrect);
+	Context->TestTrue(TEXT("Tree with a bad slot should not load"), slotCorrect);
+	Context->TestTrue(TEXT("Tree with counts that don't match its table should not load"), countCorrect);
+	Context->TestTrue(TEXT("Intact tree should load"), intactCorrect);
+
+	return cycleCorrect && sharedCorrect && slotCorrect && countCorrect && intactCorrect;
+}
+
+const FString BpVariantTreeTests_PathParsing = TEXT("BpVariantTreeTests_PathParsing");
+const FString BpVariantTreeTests_PathSurvivesSerialization = TEXT("BpVariantTreeTests_PathSurvivesSerialization");
+const FString BpVariantTreeTests_SetAndGetAtPath = TEXT("BpVariantTreeTests_SetAndGetAtPath");
+const FString BpVariantTreeTests_RemoveAndCompact = TEXT("BpVariantTreeTests_RemoveAndCompact");
+const FString BpVariantTreeTests_SerializeRoundTrips = TEXT("BpVariantTreeTests_SerializeRoundTrips");
+const FString BpVariantTreeTests_TreeSavedAgainstDefaults = TEXT("BpVariantTreeTests_TreeSavedAgainstDefaults");
+const FString BpVariantTreeTests_CompactDeepTree = TEXT("BpVariantTreeTests_CompactDeepTree");
+const FString BpVariantTreeTests_CorruptTreeIsRejected = TEXT("BpVariantTreeTests_CorruptTreeIsRejected");
+
+void BpVariantTreeTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FString> tests =
+	{
+		BpVariantTreeTests_PathParsing,
+		BpVariantTreeTests_PathSurvivesSerialization,
+		BpVariantTreeTests_SetAndGetAtPath,
+		BpVariantTreeTests_RemoveAndCompact,
+		BpVariantTreeTests_SerializeRoundTrips,
+		BpVariantTreeTests_TreeSavedAgainstDefaults,
+		BpVariantTreeTests_CompactDeepTree,
+		BpVariantTreeTests_CorruptTreeIsRejected,
+	};
+
+	for (const FString& test : tests)
+	{
+		OutBeautifiedNames.Add(test);
+		OutTestCommands.Add(test);
+	}
+}
+
+bool BpVariantTreeTests::RunTest(const FString& Parameters)
+{
+	TMap<FString, TFunction<bool()>> tests =
+	{
+		{
+			BpVariantTreeTests_PathParsing,
+			[this]() { return TestPathParsing(this); }
+		},
+		{
+			BpVariantTreeTests_PathSurvivesSerialization,
+			[this]() { return TestPathSurvivesSerialization(this); }
+		},
+		{
+			BpVariantTreeTests_SetAndGetAtPath,
+			[this]() { return TestSetAndGetAtPath(this); }
+		},
+		{
+			BpVariantTreeTests_RemoveAndCompact,
+			[this]() { return TestRemoveAndCompact(this); }
+		},
+		{
+			BpVariantTreeTests_SerializeRoundTrips,
+			[this]() { return TestTreeSerializeRoundTrips(this); }
+		},
+		{
+			BpVariantTreeTests_TreeSavedAgainstDefaults,
+			[this]() { return TestTreeSavedAgainstDefaults(this); }
+		},
+		{
+			BpVariantTreeTests_CompactDeepTree,
+			[this]() { return TestCompactDeepTree(this); }
+		},
+		{
+			BpVariantTreeTests_CorruptTreeIsRejected,
+			[this]() { return TestCorruptTreeIsRejected(this); }
+		},
+	};
+
+	if (tests.Contains(Parameters))
+	{
+		return tests[Parameters]();
+	}
+	return true;
+}
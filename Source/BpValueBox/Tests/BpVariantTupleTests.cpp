@@ -0,0 +1,141 @@
+﻿#include "Misc/AutomationTest.h"
+#include "BpVariant_Generated.h"
+#include "BpVariantTuple_Generated.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(BpVariantTupleTests, "Tests.BpVariantTupleTests",
+								  EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool TestMakeAndBreak(FAutomationTestBase* Context)
+{
+	const FBpVariantTuple3 tuple = UBpVariantTupleStatics::MakeVariantTuple3(
+		UBpVariantStatics::MakeVariantFromInt(1), UBpVariantStatics::MakeVariantFromString(TEXT("Two")), FBpVariant());
+
+	FBpVariant first;
+	FBpVariant second;
+	FBpVariant third;
+	UBpVariantTupleStatics::BreakVariantTuple3(tuple, first, second, third);
+
+	const bool valuesCorrect = UBpVariantStatics::GetInt(first) == 1 &&
+		UBpVariantStatics::GetString(second) == TEXT("Two") && UBpVariantStatics::GetType(third) == EValueType::None;
+	const bool typesCorrect = UBpVariantTupleStatics::GetVariantTuple3Type(tuple, 1) == EValueType::String &&
+		UBpVariantTupleStatics::GetVariantTuple3Type(tuple, 3) == EValueType::None;
+
+	Context->TestTrue(TEXT("Broken tuple should have the values it was made from"), valuesCorrect);
+	Context->TestTrue(TEXT("Tuple signature should have the type of every element"), typesCorrect);
+
+	return valuesCorrect && typesCorrect;
+}
+
+bool TestSignaturesMatch(FAutomationTestBase* Context)
+{
+	FBpVariantTuple10 tuple;
+	tuple.Set(0, UBpVariantStatics::MakeVariantFromInt(1));
+	tuple.Set(9, UBpVariantStatics::MakeVariantFromName(TEXT("Last")));
+
+	FBpVariantTuple10 other;
+	other.Set(0, UBpVariantStatics::MakeVariantFromInt(2));
+	other.Set(9, UBpVariantStatics::MakeVariantFromName(TEXT("Other")));
+
+	const bool matchCorrect = UBpVariantTupleStatics::VariantTuple10TypesMatch(tuple, other);
+	other.Set(9, UBpVariantStatics::MakeVariantFromString(TEXT("Other")));
+	const bool mismatchCorrect = !UBpVariantTupleStatics::VariantTuple10TypesMatch(tuple, other);
+
+	FBpVariantTuple2 pair;
+	pair.Set(0, UBpVariantStatics::MakeVariantFromFloat(1));
+	pair.Set(1, UBpVariantStatics::MakeVariantFromObject(nullptr));
+	const bool typedCorrect = pair.Matches<float, UObject*>() && !pair.Matches<double, UObject*>();
+
+	Context->TestTrue(TEXT("Tuples with the same types should match"), matchCorrect);
+	Context->TestTrue(TEXT("Tuples with different types should not match"), mismatchCorrect);
+	Context->TestTrue(TEXT("Tuple should match the C++ types it holds"), typedCorrect);
+
+	return matchCorrect && mismatchCorrect && typedCorrect;
+}
+
+bool TestSignatureFollowsReplication(FAutomationTestBase* Context)
+{
+	FBpVariantTuple3 written;
+	written.Set(0, UBpVariantStatics::MakeVariantFromInt(1));
+	written.Set(2, UBpVariantStatics::MakeVariantFromString(TEXT("Three")));
+
+	// Replication and loading write the elements straight into the struct, without going through Set
+	UScriptStruct* tupleStruct = FBpVariantTuple3::StaticStruct();
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+	bool bWriteSuccess = false;
+	tupleStruct->GetCppStructOps()->NetSerialize(writer, nullptr, bWriteSuccess, &written);
+
+	FBpVariantTuple3 replicated;
+	FMemoryReader reader(bytes);
+	bool bReadSuccess = false;
+	tupleStruct->GetCppStructOps()->NetSerialize(reader, nullptr, bReadSuccess, &replicated);
+
+	TArray<uint8> savedBytes;
+	FMemoryWriter savedWriter(savedBytes);
+	tupleStruct->SerializeItem(savedWriter, &written, nullptr);
+	FBpVariantTuple3 loaded;
+	FMemoryReader savedReader(savedBytes);
+	tupleStruct->SerializeItem(savedReader, &loaded, nullptr);
+
+	const bool valuesCorrect = UBpVariantStatics::GetInt(replicated.Get(0)) == 1 &&
+		UBpVariantStatics::GetString(replicated.Get(2)) == TEXT("Three");
+	const bool signatureCorrect = bWriteSuccess && bReadSuccess &&
+		UBpVariantTupleStatics::VariantTuple3TypesMatch(written, replicated) &&
+		UBpVariantTupleStatics::GetVariantTuple3Type(replicated, 2) == EValueType::String;
+	const bool loadCorrect = !savedReader.IsError() &&
+		UBpVariantTupleStatics::VariantTuple3TypesMatch(written, loaded) &&
+		UBpVariantStatics::GetString(loaded.Get(2)) == TEXT("Three");
+
+	Context->TestTrue(TEXT("Replicated tuple should have the written values"), valuesCorrect);
+	Context->TestTrue(TEXT("Replicated tuple signature should have the written types"), signatureCorrect);
+	Context->TestTrue(TEXT("Loaded tuple signature should have the saved types"), loadCorrect);
+
+	return valuesCorrect && signatureCorrect && loadCorrect;
+}
+
+const FString BpVariantTupleTests_MakeAndBreak = TEXT("BpVariantTupleTests_MakeAndBreak");
+const FString BpVariantTupleTests_SignaturesMatch = TEXT("BpVariantTupleTests_SignaturesMatch");
+const FString BpVariantTupleTests_SignatureFollowsReplication = TEXT("BpVariantTupleTests_SignatureFollowsReplication");
+
+void BpVariantTupleTests::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FString> tests =
+	{
+		BpVariantTupleTests_MakeAndBreak,
+		BpVariantTupleTests_SignaturesMatch,
+		BpVariantTupleTests_SignatureFollowsReplication,
+	};
+
+	for (const FString& test : tests)
+	{
+		OutBeautifiedNames.Add(test);
+		OutTestCommands.Add(test);
+	}
+}
+
+bool BpVariantTupleTests::RunTest(const FString& Parameters)
+{
+	TMap<FString, TFunction<bool()>> tests =
+	{
+		{
+			BpVariantTupleTests_MakeAndBreak,
+			[this]() { return TestMakeAndBreak(this); }
+		},
+		{
+			BpVariantTupleTests_SignaturesMatch,
+			[this]() { return TestSignaturesMatch(this); }
+		},
+		{
+			BpVariantTupleTests_SignatureFollowsReplication,
+			[this]() { return TestSignatureFollowsReplication(this); }
+		},
+	};
+
+	if (tests.Contains(Parameters))
+	{
+		return tests[Parameters]();
+	}
+	return true;
+}
@@ -4,6 +4,9 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
+#include "BpVariant.h"
+#include "BpVariantArray.h"
+#include "BpVariantTree.h"
 #include "TestObject.generated.h"
 
 /**
@@ -14,3 +17,64 @@ class BPVALUEBOX_API UTestObject : public UObject
 {
 	GENERATED_BODY()
 };
+
+/* About the size of a gameplay loadout, and counts its copies so tests can check large payloads aren't copied. */
+USTRUCT()
+struct BPVALUEBOX_API FTestLargeStruct
+{
+	GENERATED_BODY()
+
+	static inline int32 NumCopies = 0;
+
+	FTestLargeStruct() = default;
+
+	explicit FTestLargeStruct(const int32 Fill)
+	{
+		for (int32& value : Values)
+		{
+			value = Fill;
+		}
+	}
+
+	FTestLargeStruct(const FTestLargeStruct& Other)
+	{
+		*this = Other;
+	}
+
+	FTestLargeStruct& operator=(const FTestLargeStruct& Other)
+	{
+		++NumCopies;
+		FMemory::Memcpy(Values, Other.Values, sizeof(Values));
+		return *this;
+	}
+
+	UPROPERTY()
+	int32 Values[512] = {};
+};
+
+/* A struct payload that references an object, so tests can check the GC sees into struct arms. */
+USTRUCT()
+struct BPVALUEBOX_API FTestObjectStruct
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UObject> Object;
+};
+
+/* Holds variants through reflection, like gameplay code would, so tests can check what the GC sees. */
+UCLASS()
+class BPVALUEBOX_API UTestVariantHolder : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	TArray<FBpVariant> Variants;
+
+	UPROPERTY()
+	FBpVariantArray VariantArray;
+
+	UPROPERTY()
+	FBpVariantObject VariantObject;
+};